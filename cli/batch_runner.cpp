@@ -0,0 +1,200 @@
+#include "batch_runner.hpp"
+
+
+
+namespace
+{
+    std::vector<double> range(const double start, const double stop, const double step)
+    {
+        // start, start+step, ... up to stop, including stop despite rounding
+        std::vector<double> values;
+        const int factor = (step < 0 ? -1 : 1);
+        const double finalValue = stop + 0.5*factor*step;
+        for(double value = start; factor*(value - finalValue) <= 0; value += step)
+        {
+            values.push_back(value);
+        }
+        return values;
+    }
+
+
+    SWEEPPARAMETER toSweepParameter(const std::string& name)
+    {
+        if( name == "J" ) return SWEEPPARAMETER::Interaction;
+        if( name == "B" ) return SWEEPPARAMETER::Magnetic;
+        return SWEEPPARAMETER::Temperature;
+    }
+}
+
+
+
+BatchRunner::BatchRunner(const RunConfig& _config)
+  : config(_config)
+{
+}
+
+
+
+void BatchRunner::run()
+{
+    const SimulationParameters& P = config.parameters;
+    isingLOG("cli: " << P.width << "x" << P.height << " spins, J = " << P.interaction << ", B = " << P.magnetic << ", T = " << P.temperature
+                     << ", " << P.stepsEquil << " equilibration and " << P.stepsProd << " production steps")
+
+    if( P.replicaExchange )  runReplicaExchange();
+    else if( P.multiSpin )   runMultiSpinSweep();
+    else if( config.sweep.empty() ) runPoint();
+    else                     runSweep();
+}
+
+
+
+void BatchRunner::runPoint()
+{
+    // one equilibration and production run, output as from the save and correlate buttons
+
+    MC.setParameters(config.parameters);
+    MC.setup();
+
+    phase(MC, true);
+    phase(MC, false);
+
+    if( config.parameters.timeSeries )
+    {
+        MC.print_data();
+    }
+    MC.print_averages();
+
+    if( config.parameters.correlationFreq > 0 )
+    {
+        MC.print_correlationAverages();
+    }
+    else if( config.correlate )
+    {
+        const auto structureFactor = MC.getSpinsystem().computeStructureFactor();
+        auto correlation = structureFactor.computeCorrelation();
+        MC.print_correlation(correlation);
+        auto structureFunction = structureFactor.computeStructureFunction();
+        MC.print_structureFunction(structureFunction);
+        MC.print_structureFactor(structureFactor);
+    }
+}
+
+
+
+void BatchRunner::runSweep()
+{
+    // the points on all threads, one line per value is appended to the .averaged_data file in sweep order;
+    // a grid runs its rows in parallel and also writes the .grid file
+
+    sweepScheduler.setParameters(config.parameters);
+    sweepScheduler.setWarmStart( ! config.randomise );
+    if( config.grid.empty() )
+    {
+        sweepScheduler.setup(getSweepParameter(), sweepValues());
+    }
+    else
+    {
+        sweepScheduler.setup(getSweepParameter(), sweepValues(), getGridParameter(), gridValues());
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    sweepScheduler.run();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    isingLOG("cli: " << "sweep took " << elapsed.count() << " s")
+}
+
+
+
+void BatchRunner::runMultiSpinSweep()
+{
+    // every value is simulated in 64 replicas at once
+
+    if( config.correlate || config.sweep.empty() )
+    {
+        isingLOG("cli: " << "multi-spin coding writes the averages only")
+    }
+
+    multiSpin.setParameters(config.parameters);
+    multiSpin.setup();
+
+    for(const double value : sweepValues())
+    {
+        setSweepValue(value);
+        if( ! config.sweep.empty() ) isingLOG("cli: " << config.sweep << " = " << value)
+
+        multiSpin.setParameters(config.parameters);
+        if( config.randomise )
+        {
+            multiSpin.resetSpins();
+        }
+        phase(multiSpin, true);
+        multiSpin.clearRecords();
+        phase(multiSpin, false);
+        multiSpin.print_averages();
+        multiSpin.clearRecords();
+    }
+}
+
+
+
+void BatchRunner::runReplicaExchange()
+{
+    // all temperatures of the sweep in one parallel run, one replica per temperature
+
+    replicaExchange.setParameters(config.parameters);
+    replicaExchange.setAdaptive(config.parameters.adaptLadder);
+    replicaExchange.setup(sweepValues());
+
+    phase(replicaExchange, true);
+    replicaExchange.clearRecords();
+    phase(replicaExchange, false);
+
+    replicaExchange.print_averages();
+    replicaExchange.print_swapStatistics();
+}
+
+
+
+std::vector<double> BatchRunner::sweepValues() const
+{
+    // start, start+step, ... up to stop; the current point if there is no sweep
+
+    if( config.sweep.empty() )
+    {
+        return std::vector<double>(1, config.parameters.temperature);
+    }
+    return range(config.start, config.stop, config.step);
+}
+
+
+
+std::vector<double> BatchRunner::gridValues() const
+{
+    return range(config.gridStart, config.gridStop, config.gridStep);
+}
+
+
+
+void BatchRunner::setSweepValue(const double value)
+{
+    SimulationParameters& P = config.parameters;
+
+    if( config.sweep == "T" )      P.temperature = value;
+    else if( config.sweep == "J" ) P.interaction = value;
+    else if( config.sweep == "B" ) P.magnetic = value;
+}
+
+
+
+SWEEPPARAMETER BatchRunner::getSweepParameter() const
+{
+    return toSweepParameter(config.sweep);
+}
+
+
+
+SWEEPPARAMETER BatchRunner::getGridParameter() const
+{
+    return toSweepParameter(config.grid);
+}
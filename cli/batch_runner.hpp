@@ -0,0 +1,68 @@
+#pragma once
+
+
+#include "run_config.hpp"
+#include "system/montecarlohost.hpp"
+#include "system/multispin_host.hpp"
+#include "system/replica_exchange.hpp"
+#include "system/sweep_scheduler.hpp"
+#include "definitions.hpp"
+#include <chrono>
+#include <vector>
+
+
+
+// runs one RunConfig without any drawing: a single point, or a sweep the way
+// DefaultMCWidget::advancedRunAction() does it, and writes the results through the print routines of the hosts
+class BatchRunner
+{
+public:
+    explicit BatchRunner(const RunConfig&);
+    BatchRunner(const BatchRunner&) = delete;
+    void operator=(const BatchRunner&) = delete;
+
+    void run();
+
+private:
+    void runPoint();
+    void runSweep();
+    void runMultiSpinSweep();
+    void runReplicaExchange();
+
+    std::vector<double> sweepValues() const;
+    std::vector<double> gridValues() const;
+    void setSweepValue(const double);
+    SWEEPPARAMETER getSweepParameter() const;
+    SWEEPPARAMETER getGridParameter() const;
+
+    template<typename HOST>
+    void phase(HOST&, const bool EQUILMODE);
+
+    RunConfig       config;
+    MonteCarloHost  MC {};
+    MultiSpinHost   multiSpin {};
+    ReplicaExchange replicaExchange {};
+    SweepScheduler  sweepScheduler {};
+};
+
+
+
+template<typename HOST>
+void BatchRunner::phase(HOST& host, const bool EQUILMODE)
+{
+    // equilibration or production in portions of print-freq steps, one sample per portion
+
+    const SimulationParameters& P = config.parameters;
+    const unsigned long steps = EQUILMODE ? P.stepsEquil : P.stepsProd;
+    const auto start = std::chrono::steady_clock::now();
+
+    unsigned long done = 0;
+    while( done < steps )
+    {
+        host.run(P.printFreq, EQUILMODE);
+        done += P.printFreq;
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    isingLOG("cli: " << (EQUILMODE ? "equilibration: " : "production: ") << done << " steps in " << elapsed.count() << " s")
+}
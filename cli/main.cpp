@@ -0,0 +1,40 @@
+#include "batch_runner.hpp"
+#include "run_config.hpp"
+#include "lib/enhance.hpp"
+#include "definitions.hpp"
+
+#include <exception>
+#include <random>
+
+
+
+int main(int argc, char *argv[])
+{
+    isingLOG( " - - - ising-cli - - - " )
+
+    RunConfig config;
+    try
+    {
+        config = parseCommandLine(argc, argv);
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "ising-cli: " << e.what() << "\n\n" << usage();
+        return 1;
+    }
+
+    if( config.help )
+    {
+        std::cout << usage();
+        return 0;
+    }
+
+    enhance::seed = config.seed != 0 ? config.seed : std::random_device{}();
+    enhance::rand_engine.seed(enhance::seed);
+    isingLOG("main: " << "seed for random number generator: " << enhance::seed)
+
+    BatchRunner runner(config);
+    runner.run();
+
+    return 0;
+}
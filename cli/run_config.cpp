@@ -0,0 +1,305 @@
+#include "run_config.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+
+
+namespace
+{
+    std::string trimmed(const std::string& text)
+    {
+        const auto first = text.find_first_not_of(" \t\r");
+        if( first == std::string::npos ) return std::string();
+        const auto last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
+    }
+
+
+    std::string lowercase(std::string text)
+    {
+        std::transform(std::begin(text), std::end(text), std::begin(text), [](unsigned char c){ return std::tolower(c); });
+        return text;
+    }
+
+
+    template<typename T>
+    T toNumber(const std::string& key, const std::string& value)
+    {
+        std::istringstream stream(value);
+        T number {};
+        if( ! (stream >> number) || ! (stream >> std::ws).eof() )
+        {
+            throw std::invalid_argument("invalid value '" + value + "' for " + key);
+        }
+        return number;
+    }
+
+
+    unsigned long toCount(const std::string& key, const std::string& value)
+    {
+        if( value.find('-') != std::string::npos )
+        {
+            throw std::invalid_argument("invalid value '" + value + "' for " + key);
+        }
+        // allows 1e6 for step numbers
+        const double number = toNumber<double>(key, value);
+        if( number != static_cast<double>(static_cast<unsigned long>(number)) )
+        {
+            throw std::invalid_argument("invalid value '" + value + "' for " + key);
+        }
+        return static_cast<unsigned long>(number);
+    }
+
+
+    bool toBool(const std::string& key, const std::string& value)
+    {
+        const std::string v = lowercase(value);
+        if( v == "1" || v == "true" || v == "yes" || v == "on" )  return true;
+        if( v == "0" || v == "false" || v == "no" || v == "off" ) return false;
+        throw std::invalid_argument("invalid value '" + value + "' for " + key);
+    }
+
+
+    ALGORITHM toAlgorithm(const std::string& value)
+    {
+        const std::string v = lowercase(value);
+        if( v == "metropolis" )                         return ALGORITHM::Metropolis;
+        if( v == "checkerboard" )                       return ALGORITHM::Checkerboard;
+        if( v == "wolff" )                              return ALGORITHM::Wolff;
+        if( v == "swendsen-wang" || v == "swendsenwang" ) return ALGORITHM::SwendsenWang;
+        if( v == "nfold-way" || v == "nfoldway" )       return ALGORITHM::NFoldWay;
+        throw std::invalid_argument("unknown algorithm '" + value + "'");
+    }
+
+
+    bool isSwitch(const std::string& key)
+    {
+        // flags that may be given without a value
+        return key == "spin-exchange" || key == "replica-exchange" || key == "adapt-ladder" || key == "multi-spin"
+            || key == "randomise" || key == "data" || key == "correlate" || key == "help";
+    }
+}
+
+
+
+void setConfigValue(RunConfig& config, const std::string& key, const std::string& value)
+{
+    SimulationParameters& P = config.parameters;
+
+    if(      key == "width" )             P.width = toCount(key, value);
+    else if( key == "height" )            P.height = toCount(key, value);
+    else if( key == "size" )              P.width = P.height = toCount(key, value);
+    else if( key == "interaction" || key == "J" ) P.interaction = toNumber<double>(key, value);
+    else if( key == "magnetic" || key == "B" )    P.magnetic = toNumber<double>(key, value);
+    else if( key == "temperature" || key == "T" ) P.temperature = toNumber<double>(key, value);
+    else if( key == "spin-exchange" )     P.spinExchange = toBool(key, value);
+    else if( key == "ratio" )             P.ratio = toNumber<double>(key, value);
+    else if( key == "wavelength" )
+    {
+        P.wavelength = toNumber<int>(key, value);
+        P.wavelengthPattern = P.wavelength > 0;
+    }
+    else if( key == "algorithm" )         P.algorithm = toAlgorithm(value);
+    else if( key == "threads" )           P.threads = toCount(key, value);
+    else if( key == "replica-exchange" )  P.replicaExchange = toBool(key, value);
+    else if( key == "adapt-ladder" )      P.adaptLadder = toBool(key, value);
+    else if( key == "multi-spin" )        P.multiSpin = toBool(key, value);
+    else if( key == "equilibration" )     P.stepsEquil = toCount(key, value);
+    else if( key == "production" )        P.stepsProd = toCount(key, value);
+    else if( key == "print-freq" )        P.printFreq = toCount(key, value);
+    else if( key == "correlate-freq" )    P.correlationFreq = toCount(key, value);
+    else if( key == "key" )               P.fileKey = value;
+    else if( key == "sweep" )
+    {
+        config.sweep = value;
+        if( value != "T" && value != "J" && value != "B" ) throw std::invalid_argument("sweep must be one of T, J, B");
+    }
+    else if( key == "grid" )
+    {
+        config.grid = value;
+        if( value != "T" && value != "J" && value != "B" ) throw std::invalid_argument("grid must be one of T, J, B");
+    }
+    else if( key == "grid-start" )        config.gridStart = toNumber<double>(key, value);
+    else if( key == "grid-stop" )         config.gridStop = toNumber<double>(key, value);
+    else if( key == "grid-step" )         config.gridStep = toNumber<double>(key, value);
+    else if( key == "start" )             config.start = toNumber<double>(key, value);
+    else if( key == "stop" )              config.stop = toNumber<double>(key, value);
+    else if( key == "step" )              config.step = toNumber<double>(key, value);
+    else if( key == "randomise" )         config.randomise = toBool(key, value);
+    else if( key == "data" )              P.timeSeries = toBool(key, value);
+    else if( key == "correlate" )         config.correlate = toBool(key, value);
+    else if( key == "seed" )              config.seed = toCount(key, value);
+    else if( key == "help" )              config.help = toBool(key, value);
+    else if( key == "config" )            readConfigFile(config, value);
+    else throw std::invalid_argument("unknown parameter '" + key + "'");
+}
+
+
+
+void readConfigFile(RunConfig& config, const std::string& filename)
+{
+    std::ifstream FILE(filename);
+    if( ! FILE.is_open() )
+    {
+        throw std::invalid_argument("cannot open config file '" + filename + "'");
+    }
+
+    std::string line;
+    unsigned int number = 0;
+    while( std::getline(FILE, line) )
+    {
+        ++number;
+        line = trimmed(line.substr(0, line.find('#')));
+        if( line.empty() ) continue;
+
+        const auto equals = line.find('=');
+        if( equals == std::string::npos )
+        {
+            throw std::invalid_argument(filename + ":" + std::to_string(number) + ": expected key = value");
+        }
+        setConfigValue(config, trimmed(line.substr(0, equals)), trimmed(line.substr(equals + 1)));
+    }
+}
+
+
+
+RunConfig parseCommandLine(int argc, char* argv[])
+{
+    RunConfig config;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if( arg == "-h" ) arg = "--help";
+        if( arg.size() < 3 || arg.compare(0, 2, "--") != 0 )
+        {
+            throw std::invalid_argument("unexpected argument '" + arg + "'");
+        }
+        arg.erase(0, 2);
+
+        const auto equals = arg.find('=');
+        if( equals != std::string::npos )
+        {
+            setConfigValue(config, arg.substr(0, equals), arg.substr(equals + 1));
+        }
+        else if( isSwitch(arg) && (i + 1 == argc || std::string(argv[i + 1]).compare(0, 2, "--") == 0) )
+        {
+            setConfigValue(config, arg, "true");
+        }
+        else if( i + 1 < argc )
+        {
+            setConfigValue(config, arg, argv[++i]);
+        }
+        else
+        {
+            throw std::invalid_argument("missing value for " + arg);
+        }
+    }
+
+    // the limits of the spin boxes of the GUI
+    const SimulationParameters& P = config.parameters;
+    if( P.width < 1 || P.height < 1 )
+    {
+        throw std::invalid_argument("width and height must be at least 1");
+    }
+    if( P.threads < 1 )
+    {
+        throw std::invalid_argument("threads must be at least 1");
+    }
+    if( ! (P.temperature > 0) )
+    {
+        throw std::invalid_argument("T must be positive");
+    }
+    if( config.sweep == "T" && ! (config.start > 0 && config.stop > 0) )
+    {
+        throw std::invalid_argument("a temperature sweep needs positive start and stop values");
+    }
+    if( config.grid == "T" && ! (config.gridStart > 0 && config.gridStop > 0) )
+    {
+        throw std::invalid_argument("a temperature grid needs positive grid-start and grid-stop values");
+    }
+    if( config.parameters.printFreq == 0 )
+    {
+        throw std::invalid_argument("print-freq must be positive");
+    }
+    if( ! config.sweep.empty() && (config.step == 0 || (config.stop - config.start) * config.step < 0) )
+    {
+        throw std::invalid_argument("sweep needs a step leading from start to stop");
+    }
+    if( ! config.grid.empty() )
+    {
+        if( config.sweep.empty() || config.grid == config.sweep )
+        {
+            throw std::invalid_argument("grid needs a sweep over another parameter");
+        }
+        if( config.gridStep == 0 || (config.gridStop - config.gridStart) * config.gridStep < 0 )
+        {
+            throw std::invalid_argument("grid needs a grid-step leading from grid-start to grid-stop");
+        }
+        if( config.parameters.replicaExchange || config.parameters.multiSpin )
+        {
+            throw std::invalid_argument("grid sweeps run neither replica exchange nor multi-spin coding");
+        }
+    }
+    if( config.parameters.replicaExchange && config.sweep != "T" )
+    {
+        throw std::invalid_argument("replica exchange needs a temperature sweep as its ladder");
+    }
+    if( config.parameters.replicaExchange && config.parameters.correlationFreq > 0 )
+    {
+        throw std::invalid_argument("replica exchange writes averages only, correlate-freq is not supported");
+    }
+
+    return config;
+}
+
+
+
+std::string usage()
+{
+    return
+        "usage: ising-cli [--config FILE] [--key value | --key=value] ...\n"
+        "\n"
+        "Runs equilibration and production without a GUI and writes the same files as the GUI,\n"
+        "named after --key: .averaged_data, with --data .data, with --correlate .correlation, .structureFunction,\n"
+        ".structureFactor (S(kx, ky)),\n"
+        "sweeps with warm start .equilibration, grid sweeps .grid.\n"
+        "A config file holds one 'key = value' per line, '#' starts a comment.\n"
+        "\n"
+        "system\n"
+        "  width, height, size          lattice size [100]\n"
+        "  J | interaction              coupling [1]\n"
+        "  B | magnetic                 field [0]\n"
+        "  T | temperature              temperature [1]\n"
+        "  spin-exchange                conserved magnetisation (Kawasaki) [false]\n"
+        "  ratio                        fraction of up spins with spin-exchange [0.5]\n"
+        "  wavelength                   start from a cosine pattern of this wavelength [0: random]\n"
+        "update scheme\n"
+        "  algorithm                    metropolis, checkerboard, wolff, swendsen-wang, nfold-way [metropolis]\n"
+        "  threads                      threads of the parallel sweeps [1]\n"
+        "  multi-spin                   64 replicas per lattice word, with a sweep [false]\n"
+        "  replica-exchange             parallel tempering over the temperatures of a T sweep [false]\n"
+        "  adapt-ladder                 adapt the replica exchange ladder [false]\n"
+        "runs\n"
+        "  equilibration, production    number of steps [0]\n"
+        "  print-freq                   steps between two samples [1]\n"
+        "  key                          name of the output files\n"
+        "  data                         stream the time series of a single point to .data while it runs [false]\n"
+        "  correlate                    write G(r), S(k) and S(kx, ky) of the final configuration [false]\n"
+        "  correlate-freq               instead average them with errors over every n-th sample [0: off]\n"
+        "  seed                         random seed [0: random]\n"
+        "sweep\n"
+        "  sweep                        parameter to vary: T, J or B\n"
+        "  start, stop, step            values of the sweep\n"
+        "  randomise                    start every point from a random configuration [false]; otherwise a point\n"
+        "                               starts from the lattice of its neighbour and ends its equilibration once\n"
+        "                               energy and magnetisation are stationary, see the .equilibration file\n"
+        "grid\n"
+        "  grid                         second parameter to vary, one row of the sweep per value: T, J or B\n"
+        "  grid-start, -stop, -step     values of the grid parameter; the rows are walked back and forth\n"
+        "                               and shared out to the threads, each point starts from the lattice\n"
+        "                               of its neighbour\n";
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+
+#include "system/simulation_parameters.hpp"
+#include "definitions.hpp"
+#include <string>
+
+
+
+// everything ising-cli needs for one batch job: the simulation parameters and what to run with them.
+// Values come from a config file with one "key = value" per line ('#' starts a comment) and from
+// command line flags "--key value" or "--key=value", flags given after --config override the file.
+struct RunConfig
+{
+    SimulationParameters parameters {};
+
+    // sweep over T, J or B like the advanced run of the GUI, a single point if empty
+    std::string   sweep {};
+    double        start {0};
+    double        stop {0};
+    double        step {0};
+    bool          randomise {false};      // start every point from a random configuration instead of a warm start
+
+    // second parameter of a grid sweep, one row of the sweep per value, no grid if empty
+    std::string   grid {};
+    double        gridStart {0};
+    double        gridStop {0};
+    double        gridStep {0};
+
+    bool          correlate {false};      // G(r) and S(k) of the final configuration
+    unsigned int  seed {0};               // 0: seed from std::random_device
+    bool          help {false};
+};
+
+
+void readConfigFile(RunConfig&, const std::string&);
+void setConfigValue(RunConfig&, const std::string&, const std::string&);
+RunConfig parseCommandLine(int, char*[]);
+std::string usage();
@@ -122,7 +122,7 @@ void GridWidget::draw_test()
             height_of_rectangular, 
             QPen(Qt::transparent), 
                 // getSpinColor( Spin(0, SPINTYPE(rand()%2*2)) 
-                getSpinColor( Spin(0, rand()%2 == 1 ? 1 : -1) 
+                getSpinColor( Spin(rand()%2 == 1 ? 1 : -1) 
         ));
     }
 }
@@ -148,6 +148,8 @@ void GridWidget::draw( const Spinsystem& system )
     setColumns(system.getWidth());
     setRows(system.getHeight());
     
+    // the simulation thread may switch the storage of the spins meanwhile
+    const auto lock = system.lockStorage();
     for(unsigned short row = 0; row < rows; ++row)
     for(unsigned short column = 0; column < columns; ++column)
     {
@@ -158,7 +160,7 @@ void GridWidget::draw( const Spinsystem& system )
             width_of_rectangular, 
             height_of_rectangular, 
             QPen(Qt::transparent), 
-                getSpinColor( system.getSpins().at(columns*row + column) 
+                getSpinColor( Spin(system.getSpinType(columns*row + column)) 
         ));
     }
 }
@@ -68,6 +68,10 @@ MainWindow::MainWindow(QWidget *parent) :
         connect( prmsWidget, &BaseParametersWidget::criticalValueChanged, mcWidget, &BaseMCWidget::makeSystemNew );
         connect( prmsWidget, &BaseParametersWidget::valueChanged, mcWidget, &BaseMCWidget::makeRecordsNew );
         connect( prmsWidget, &BaseParametersWidget::randomise, mcWidget, &BaseMCWidget::makeSystemRandom);
+        connect( mcWidget, &BaseMCWidget::statusMessage, [&](const QString& message)
+        {
+            ui->statusBar->showMessage(message);
+        });
     }
     
     // ### upper chart: hamiltonianChart
@@ -123,6 +127,7 @@ MainWindow::MainWindow(QWidget *parent) :
             {
                 for(const auto& B : correlation )
                 {
+                    if( B.entries == 0 ) continue;
                     correlationChart->append(B.position(), B.counter);
                 }
                 correlationChart->refresh();
@@ -51,8 +51,9 @@ void BaseMCWidget::setParameters(BaseParametersWidget* widget_ptr)
     
     if( ! parameters_linked.load() )
     {
-        MC.setParameters(prmsWidget);
+        MC.setParameters(prmsWidget->getSimulationParameters());
         MC.setup();
+        showSystemSize();
         emit drawRequest(MC, steps_done.load());
     }
 }
@@ -64,7 +65,9 @@ void BaseMCWidget::makeSystemNew()
     qDebug() << __PRETTY_FUNCTION__;
     Q_CHECK_PTR(prmsWidget);
 
+    MC.setParameters(prmsWidget->getSimulationParameters());
     MC.setup();
+    showSystemSize();
     steps_done.store(0);
     emit resetChartSignal();
     emit drawRequest(MC, steps_done.load());
@@ -77,6 +80,7 @@ void BaseMCWidget::makeRecordsNew()
     qDebug() << __PRETTY_FUNCTION__;
     Q_CHECK_PTR(prmsWidget);
 
+    MC.publish(std::make_shared<const SimulationParameters>(prmsWidget->getSimulationParameters()));
     MC.clearRecords();
     steps_done.store(0);
     emit resetChartSignal();
@@ -89,6 +93,7 @@ void BaseMCWidget::makeSystemRandom()
     qDebug() << __PRETTY_FUNCTION__;
     Q_CHECK_PTR(prmsWidget);
 
+    MC.setParameters(prmsWidget->getSimulationParameters());
     MC.clearRecords();
     MC.resetSpins();
     steps_done.store(0);
@@ -109,20 +114,46 @@ void BaseMCWidget::saveAction()
 
 
 
+void BaseMCWidget::takeSnapshot()
+{
+    // parameters of the next run, taken on the GUI thread before a server is started: the server
+    // reads runParameters, the engine takes over its own copy before its next step
+
+    qDebug() << __PRETTY_FUNCTION__;
+    Q_CHECK_PTR(prmsWidget);
+
+    runParameters = prmsWidget->getSimulationParameters();
+    MC.publish(std::make_shared<const SimulationParameters>(runParameters));
+}
+
+
+
+void BaseMCWidget::showSystemSize()
+{
+    // the engine rounds odd sizes up in spin-exchange mode, show the size it uses
+
+    Q_CHECK_PTR(prmsWidget);
+
+    const auto& system = MC.getSpinsystem();
+    if( system.getWidth()  != prmsWidget->getWidth() )  prmsWidget->setWidth(system.getWidth());
+    if( system.getHeight() != prmsWidget->getHeight() ) prmsWidget->setHeight(system.getHeight());
+}
+
+
+
 // DO NOT emit from server
 void BaseMCWidget::server()
 {
     qDebug() << __PRETTY_FUNCTION__;
-    Q_CHECK_PTR(prmsWidget);
     
     if( equilibration_mode.load() == true )
     {
-        while(simulation_running.load() && steps_done.load() < prmsWidget->getStepsEquil())
+        while(simulation_running.load() && steps_done.load() < runParameters.stepsEquil)
         {
-            MC.run(prmsWidget->getPrintFreq(), true);
-            steps_done.store(steps_done.load() + prmsWidget->getPrintFreq());
+            MC.run(runParameters.printFreq, true);
+            steps_done.store(steps_done.load() + runParameters.printFreq);
             
-            if( steps_done.load() >= prmsWidget->getStepsEquil() )
+            if( steps_done.load() >= runParameters.stepsEquil )
             {
                 emit pauseBtn->clicked();
             }
@@ -130,13 +161,17 @@ void BaseMCWidget::server()
     }
     else
     {
-        while(simulation_running.load() && steps_done.load() < prmsWidget->getStepsProd())
+        while(simulation_running.load() && steps_done.load() < runParameters.stepsProd)
         {
-            MC.run(prmsWidget->getPrintFreq(), false);
-            steps_done.store(steps_done.load() + prmsWidget->getPrintFreq());
+            MC.run(runParameters.printFreq, false);
+            steps_done.store(steps_done.load() + runParameters.printFreq);
             
-            if (steps_done.load() >= prmsWidget->getStepsProd())
+            if (steps_done.load() >= runParameters.stepsProd)
             {
+                if( runParameters.correlationFreq > 0 )
+                {
+                    MC.print_correlationAverages();
+                }
                 emit pauseBtn->clicked();
             }
         }
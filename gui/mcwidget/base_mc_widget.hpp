@@ -54,6 +54,7 @@ signals:
     void drawRequest(const MonteCarloHost&, const unsigned long);
     void drawCorrelationRequest(const Histogram<double>&);
     void finishedSteps(const unsigned long);
+    void statusMessage(const QString&);
     
 protected:
     explicit BaseMCWidget(QWidget* parent = Q_NULLPTR);
@@ -61,8 +62,11 @@ protected:
     void operator=(const BaseMCWidget&) = delete;
 
     void server();
+    void takeSnapshot();
+    void showSystemSize();
     
     BaseParametersWidget* prmsWidget = Q_NULLPTR;
+    SimulationParameters  runParameters {};      // parameters of the current run, read by the server threads
     QPushButton* equilBtn = new QPushButton("Equilibration Run",this);
     QPushButton* prodBtn = new QPushButton("Production Run",this);
     QPushButton* pauseBtn = new QPushButton("Pause",this);
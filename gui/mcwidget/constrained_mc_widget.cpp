@@ -114,7 +114,8 @@ void ConstrainedMCWidget::equilibrateAction()
     emit drawRequest(MC, steps_done.load());
     emit runningSignal(true);
 
-    isingLOG("gui: " << "start equilibration with " << prmsWidget->getStepsEquil() - steps_done.load() << " steps")
+    takeSnapshot();
+    isingLOG("gui: " << "start equilibration with " << runParameters.stepsEquil - steps_done.load() << " steps")
     
     QFuture<void> future = QtConcurrent::run([&]
     {
@@ -149,7 +150,8 @@ void ConstrainedMCWidget::productionAction()
     emit drawRequest(MC, steps_done.load());
     emit runningSignal(true);
     
-    isingLOG("gui: " << "start production with " << prmsWidget->getStepsProd() - steps_done.load() << " steps")
+    takeSnapshot();
+    isingLOG("gui: " << "start production with " << runParameters.stepsProd - steps_done.load() << " steps")
 
     QFuture<void> future = QtConcurrent::run([&]
     {
@@ -238,10 +240,12 @@ void ConstrainedMCWidget::serverCorrelation()
     CONSTRAINED_MC_WIDGET_ASSERT_ALL;
     Q_CHECK_PTR(prmsWidget);
     
-    auto correlation = MC.getSpinsystem().computeCorrelation();
+    const auto structureFactor = MC.getSpinsystem().computeStructureFactor();
+    auto correlation = structureFactor.computeCorrelation();
     MC.print_correlation( correlation );
-    auto structureFunction = MC.getSpinsystem().computeStructureFunction(correlation);
+    auto structureFunction = structureFactor.computeStructureFunction();
     MC.print_structureFunction( structureFunction );
+    MC.print_structureFactor( structureFactor );
     emit drawCorrelationRequest( correlation );
 
     
@@ -117,7 +117,8 @@ void DefaultMCWidget::equilibrateAction()
     drawRequestTimer->start(drawRequestTime.load());
     emit runningSignal(true);
 
-    isingLOG("gui: " << "start equilibration with " << prmsWidget->getStepsEquil() - steps_done.load() << " steps")
+    takeSnapshot();
+    isingLOG("gui: " << "start equilibration with " << runParameters.stepsEquil - steps_done.load() << " steps")
     
     QFuture<void> future = QtConcurrent::run([&]
     {
@@ -153,7 +154,8 @@ void DefaultMCWidget::productionAction()
     drawRequestTimer->start(drawRequestTime.load());
     emit runningSignal(true);
     
-    isingLOG("gui: " << "start production with " << prmsWidget->getStepsProd() - steps_done.load() << " steps")
+    takeSnapshot();
+    isingLOG("gui: " << "start production with " << runParameters.stepsProd - steps_done.load() << " steps")
 
     QFuture<void> future = QtConcurrent::run([&]
     {
@@ -194,6 +196,7 @@ void DefaultMCWidget::abortAction()
     DEFAULT_MC_WIDGET_ASSERT_ALL;
     
     setRunning(false);
+    sweepScheduler.stop();
     equilBtn->setEnabled(true);
     prodBtn->setEnabled(true);
     pauseBtn->setEnabled(false);
@@ -238,42 +241,60 @@ void DefaultMCWidget::advancedRunAction()
     double value = prmsWidget->getStartValue();
     int factor = (prmsWidget->getStepValue() < 0 ? -1 : 1);
     double finalValue = prmsWidget->getStopValue() + 0.5*factor*prmsWidget->getStepValue();
-    while( factor*(value - finalValue) <= 0)
+
+    if( prmsWidget->getReplicaExchange() )
     {
-        prmsWidget->setAdvancedValue(value);
-        if( prmsWidget->getAdvancedRandomise() )
+        // all temperatures in one parallel run, one replica per temperature
+        std::vector<double> ladder;
+        while( factor*(value - finalValue) <= 0)
         {
-            MC.resetSpins();
+            ladder.push_back(value);
+            value += prmsWidget->getStepValue();
         }
-        steps_done.store(0);
-        emit resetChartSignal();
-        equilibration_mode.store(true);
+        replicaExchange.setParameters(prmsWidget->getSimulationParameters());
+        replicaExchange.setAdaptive(prmsWidget->getAdaptLadder());
+        replicaExchange.setup(ladder);
+
+        advancedPhase(true);
+        replicaExchange.clearRecords();
+        advancedPhase(false);
+
+        replicaExchange.print_averages();
+        replicaExchange.print_swapStatistics();
+    }
+    else if( prmsWidget->getMultiSpin() )
+    {
+        // every value is simulated in 64 replicas at once
+        multiSpin.setParameters(prmsWidget->getSimulationParameters());
+        multiSpin.setup();
+        while( factor*(value - finalValue) <= 0)
         {
-            QEventLoop pause;
-            connect(this, &DefaultMCWidget::serverReturn, &pause, &QEventLoop::quit);
-            QFuture<void> future = QtConcurrent::run([&]
+            prmsWidget->setAdvancedValue(value);
+            multiSpin.setParameters(prmsWidget->getSimulationParameters());
+            if( prmsWidget->getAdvancedRandomise() )
             {
-                serverAdvanced();
-            });
-            pause.exec();
-        }
+                multiSpin.resetSpins();
+            }
+            advancedPhase(true);
+            multiSpin.clearRecords();
+            advancedPhase(false);
+            multiSpin.print_averages();
+            multiSpin.clearRecords();
 
-        steps_done.store(0);
-        equilibration_mode.store(false);
-        emit resetChartSignal();
+            value += prmsWidget->getStepValue();
+        }
+    }
+    else
+    {
+        // points or a grid of them in parallel, each from the configuration of its neighbour
+        // or if randomised from its own random one
+        std::vector<double> values;
+        while( factor*(value - finalValue) <= 0)
         {
-            QEventLoop pause;
-            connect(this, &DefaultMCWidget::serverReturn, &pause, &QEventLoop::quit);
-            QFuture<void> future = QtConcurrent::run([&]
-            {
-                serverAdvanced();
-            });
-            pause.exec();
+            values.push_back(value);
+            value += prmsWidget->getStepValue();
         }
-        MC.print_averages();
-        MC.clearRecords();
-
-        value += prmsWidget->getStepValue();
+        advancedSweep(values);
     }
 
     setRunning(false);
@@ -291,30 +312,145 @@ void DefaultMCWidget::advancedRunAction()
 
 
 
-void DefaultMCWidget::serverAdvanced()
+void DefaultMCWidget::advancedPhase(const bool EQUILMODE)
+{
+    // equilibration or production run of the advanced scheme, returns when serverAdvanced() has finished
+
+    qDebug() << __PRETTY_FUNCTION__;
+
+    steps_done.store(0);
+    equilibration_mode.store(EQUILMODE);
+    emit resetChartSignal();
+
+    QEventLoop pause;
+    connect(this, &DefaultMCWidget::serverReturn, &pause, &QEventLoop::quit);
+    takeSnapshot();
+    QFuture<void> future = QtConcurrent::run([&]
+    {
+        serverAdvanced();
+    });
+    pause.exec();
+}
+
+
+
+void DefaultMCWidget::advancedSweep(const std::vector<double>& values)
 {
+    // all values on the sweep scheduler, with a grid once for every value of the grid parameter; returns when
+    // they are done or the run has been aborted, meanwhile the status bar shows what every worker is doing
+
     qDebug() << __PRETTY_FUNCTION__;
+
+    sweepScheduler.setParameters(prmsWidget->getSimulationParameters());
+    sweepScheduler.setWarmStart( ! prmsWidget->getAdvancedRandomise() );
+    if( prmsWidget->getGrid() )
+    {
+        std::vector<double> rowValues;
+        const double step = prmsWidget->getGridStepValue();
+        const int factor = (step < 0 ? -1 : 1);
+        const double finalValue = prmsWidget->getGridStopValue() + 0.5*factor*step;
+        for( double value = prmsWidget->getGridStartValue(); factor*(value - finalValue) <= 0 && step != 0; value += step )
+        {
+            rowValues.push_back(value);
+        }
+        if( rowValues.empty() )
+        {
+            rowValues.push_back(prmsWidget->getGridStartValue());
+        }
+        sweepScheduler.setup(prmsWidget->getAdvancedParameter(), values, prmsWidget->getGridParameter(), rowValues);
+    }
+    else
+    {
+        sweepScheduler.setup(prmsWidget->getAdvancedParameter(), values);
+    }
+
+    QEventLoop pause;
+    connect(this, &DefaultMCWidget::serverReturn, &pause, &QEventLoop::quit);
+    QTimer statusTimer;
+    connect(&statusTimer, &QTimer::timeout, [&]{ emit statusMessage(sweepStatus()); });
+    statusTimer.start(500);
+    QFuture<void> future = QtConcurrent::run([&]
+    {
+        sweepScheduler.run();
+        emit serverReturn();
+    });
+    pause.exec();
+    statusTimer.stop();
+    emit statusMessage(sweepStatus());
+}
+
+
+
+QString DefaultMCWidget::sweepStatus() const
+{
+    // "sweep: 3/40 points | #0: T = 2.27 equilibration 40% | #1: idle | ...", on a grid "#0: T = 2.27, B = 0.1 ..."
+
     Q_CHECK_PTR(prmsWidget);
+
+    const char* names[] = {"T", "J", "B"};
+    const char* name = names[prmsWidget->getAdvancedParameter()];
+    const char* gridName = names[prmsWidget->getGridParameter()];
+
+    QString text = QString("sweep: %1/%2 points").arg(sweepScheduler.getPointsDone()).arg(sweepScheduler.getPoints());
+    if( ! prmsWidget->getAdvancedRandomise() )
+    {
+        text += QString(", %1 equilibration steps saved").arg(sweepScheduler.getStepsSaved());
+    }
+    unsigned int worker = 0;
+    for( const auto& S : sweepScheduler.getStatus() )
+    {
+        text += QString("  |  #%1: ").arg(worker++);
+        if( S.busy )
+        {
+            const unsigned long percent = S.stepsTotal > 0 ? 100*S.stepsDone/S.stepsTotal : 100;
+            text += QString("%1 = %2").arg(name).arg(S.value);
+            if( sweepScheduler.isGrid() )
+            {
+                text += QString(", %1 = %2").arg(gridName).arg(S.rowValue);
+            }
+            text += QString(" %1 %2%").arg(S.equilibrating ? "equilibration" : "production").arg(percent);
+        }
+        else
+        {
+            text += "idle";
+        }
+    }
+    return text;
+}
+
+
+
+void DefaultMCWidget::serverAdvanced()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+
+    // with replica exchange or multi-spin coding every replica does the steps
+    auto run = [&](const bool EQUILMODE)
+    {
+        if( runParameters.replicaExchange ) replicaExchange.run(runParameters.printFreq, EQUILMODE);
+        else if( runParameters.multiSpin )  multiSpin.run(runParameters.printFreq, EQUILMODE);
+        else                                MC.run(runParameters.printFreq, EQUILMODE);
+    };
     
     if( equilibration_mode.load() == true )
     {
-        while(simulation_running.load() && steps_done.load() < prmsWidget->getStepsEquil())
+        while(simulation_running.load() && steps_done.load() < runParameters.stepsEquil)
         {
-            MC.run(prmsWidget->getPrintFreq(), true);
-            steps_done.store(steps_done.load() + prmsWidget->getPrintFreq());
+            run(true);
+            steps_done.store(steps_done.load() + runParameters.printFreq);
             
-            if( steps_done.load() >= prmsWidget->getStepsEquil() )
+            if( steps_done.load() >= runParameters.stepsEquil )
                 emit serverReturn();
         }
     }
     else
     {
-        while(simulation_running.load() && steps_done.load() < prmsWidget->getStepsProd())
+        while(simulation_running.load() && steps_done.load() < runParameters.stepsProd)
         {
-            MC.run(prmsWidget->getPrintFreq(), false);
-            steps_done.store(steps_done.load() + prmsWidget->getPrintFreq());
+            run(false);
+            steps_done.store(steps_done.load() + runParameters.printFreq);
             
-            if (steps_done.load() >= prmsWidget->getStepsProd())
+            if (steps_done.load() >= runParameters.stepsProd)
             {
                 emit serverReturn();
             }
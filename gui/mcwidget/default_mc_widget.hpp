@@ -8,6 +8,10 @@
 
 
 #include "mcwidget/base_mc_widget.hpp"
+#include "system/replica_exchange.hpp"
+#include "system/multispin_host.hpp"
+#include "system/sweep_scheduler.hpp"
+#include <vector>
 
 
 
@@ -36,8 +40,14 @@ signals:
 private:
     QPushButton* advancedRunBtn = new QPushButton("Advanced Simulation Scheme", this);
     // std::vector<double> advancedValues {};
+    ReplicaExchange replicaExchange {};
+    MultiSpinHost   multiSpin {};
+    SweepScheduler  sweepScheduler {};
 
+    void advancedPhase(const bool);
+    void advancedSweep(const std::vector<double>&);
     void serverAdvanced();
+    QString sweepStatus() const;
 
 };
 
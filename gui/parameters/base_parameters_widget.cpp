@@ -11,7 +11,8 @@
     Q_CHECK_PTR(stepsProdExponentSpinBox); \
     Q_CHECK_PTR(printFreqSpinBox);   \
     Q_CHECK_PTR(randomiseBtn);       \
-    Q_CHECK_PTR(filenameLineEdit);    
+    Q_CHECK_PTR(filenameLineEdit);   \
+    Q_CHECK_PTR(timeSeriesCheckBox);
 
 
 
@@ -51,11 +52,13 @@ QGroupBox* BaseParametersWidget::createOutputBox()
     filenameLineEdit->setMaxLength(20);
     filenameLineEdit->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     filenameLineEdit->setAlignment(Qt::AlignRight);
+    timeSeriesCheckBox->setToolTip("stream every sample of the run to the .data file, written out by Save");
 
     // the layout
     QFormLayout* formLayout = new QFormLayout();
     formLayout->setLabelAlignment(Qt::AlignVCenter);
     formLayout->addRow("file key:",filenameLineEdit);
+    formLayout->addRow("time series:",timeSeriesCheckBox);
 
     // set group layout
     labelBox->setLayout(formLayout);
@@ -134,3 +137,37 @@ std::string BaseParametersWidget::getFileKey() const
 }
 
 
+bool BaseParametersWidget::getTimeSeries() const
+{
+    Q_CHECK_PTR(timeSeriesCheckBox);
+    return timeSeriesCheckBox->isChecked();
+}
+
+
+SimulationParameters BaseParametersWidget::getSimulationParameters() const
+{
+    // snapshot of all values for the engine, to be taken on the GUI thread only
+
+    SimulationParameters P;
+    P.width             = getWidth();
+    P.height            = getHeight();
+    P.interaction       = getInteraction();
+    P.magnetic          = getMagnetic();
+    P.temperature       = getTemperature();
+    P.spinExchange      = getConstrained();
+    P.ratio             = getRatio();
+    P.wavelengthPattern = getWavelengthPattern();
+    P.wavelength        = getWavelength();
+    P.algorithm         = getAlgorithm();
+    P.threads           = getThreads();
+    P.replicaExchange   = getReplicaExchange();
+    P.adaptLadder       = getAdaptLadder();
+    P.multiSpin         = getMultiSpin();
+    P.stepsEquil        = getStepsEquil();
+    P.stepsProd         = getStepsProd();
+    P.printFreq         = getPrintFreq();
+    P.correlationFreq   = getCorrelationFreq();
+    P.fileKey           = getFileKey();
+    P.timeSeries        = getTimeSeries();
+    return P;
+}
@@ -8,6 +8,8 @@
 #endif
 
 // #include "long_qspinbox.hpp"
+#include "definitions.hpp"
+#include "system/simulation_parameters.hpp"
 #include <QWidget>
 #include <QGroupBox>
 #include <QLineEdit>
@@ -44,6 +46,9 @@ public:
     unsigned long getStepsProd() const;
     unsigned int  getPrintFreq() const;
     std::string getFileKey() const;
+    bool        getTimeSeries() const;
+
+    SimulationParameters getSimulationParameters() const;
 
     virtual double getMagnetic() const = 0;
     virtual double getRatio() const = 0;
@@ -54,6 +59,18 @@ public:
     virtual double getStopValue() const = 0;
     virtual double getStepValue() const = 0;
     virtual bool   getAdvancedRandomise() const = 0;
+    virtual SWEEPPARAMETER getAdvancedParameter() const = 0;
+    virtual bool   getGrid() const = 0;
+    virtual SWEEPPARAMETER getGridParameter() const = 0;
+    virtual double getGridStartValue() const = 0;
+    virtual double getGridStopValue() const = 0;
+    virtual double getGridStepValue() const = 0;
+    virtual ALGORITHM    getAlgorithm() const = 0;
+    virtual unsigned int getThreads() const = 0;
+    virtual bool         getReplicaExchange() const = 0;
+    virtual bool         getAdaptLadder() const = 0;
+    virtual bool         getMultiSpin() const = 0;
+    virtual unsigned int getCorrelationFreq() const = 0;
     
     virtual void setAdvancedValue(const double) = 0;
     
@@ -90,6 +107,7 @@ protected:
     QSpinBox* printFreqSpinBox = new QSpinBox(this);
 
     QLineEdit* filenameLineEdit = new QLineEdit(this);
+    QCheckBox* timeSeriesCheckBox = new QCheckBox(this);
     
     // Buttons
     QPushButton* randomiseBtn = new QPushButton("Randomise spins", this);
@@ -12,10 +12,12 @@
     Q_CHECK_PTR(printFreqSpinBox);   \
     Q_CHECK_PTR(randomiseBtn);       \
     Q_CHECK_PTR(filenameLineEdit);   \
+    Q_CHECK_PTR(timeSeriesCheckBox); \
     Q_CHECK_PTR(wavelengthSpinBox);  \
     Q_CHECK_PTR(wavelengthCheckBox); \
     Q_CHECK_PTR(ratioCheckBox); \
-    Q_CHECK_PTR(ratioSpinBox);    
+    Q_CHECK_PTR(ratioSpinBox);  \
+    Q_CHECK_PTR(correlationFreqSpinBox);
 
 
 
@@ -240,6 +242,12 @@ QGroupBox* ConstrainedParametersWidget::createProdBox()
     stepsProdExponentSpinBox->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     stepsProdExponentSpinBox->setAlignment(Qt::AlignRight);
 
+    correlationFreqSpinBox->setMinimum(0);
+    correlationFreqSpinBox->setMaximum(1000000);
+    correlationFreqSpinBox->setSingleStep(10);
+    correlationFreqSpinBox->setSpecialValueText("off");
+    correlationFreqSpinBox->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+
     // the layout
     QLabel* label = new QLabel(this);
     label->setFrameStyle(QFrame::NoFrame);
@@ -256,6 +264,7 @@ QGroupBox* ConstrainedParametersWidget::createProdBox()
     formLayout->setLabelAlignment(Qt::AlignVCenter);
     formLayout->addRow("production steps", stepOptions);
     formLayout->addRow("save every ...th step", printFreqSpinBox);
+    formLayout->addRow("average G(r) every ...th save", correlationFreqSpinBox);
 
     // set group layout
     labelBox->setLayout(formLayout);
@@ -286,10 +295,12 @@ void ConstrainedParametersWidget::setReadOnly(bool flag)
     printFreqSpinBox->setReadOnly(flag);
     randomiseBtn->setEnabled(!flag);
     filenameLineEdit->setReadOnly(flag);
+    timeSeriesCheckBox->setEnabled(!flag);
     ratioSpinBox->setReadOnly(flag);
     ratioCheckBox->setEnabled(!flag);
     wavelengthSpinBox->setReadOnly(flag);
     wavelengthCheckBox->setEnabled(!flag);
+    correlationFreqSpinBox->setReadOnly(flag);
 
 }
 
@@ -321,9 +332,11 @@ void ConstrainedParametersWidget::setDefault()
     interactionSpinBox->setValue(1.0);
     temperatureSpinBox->setValue(1.0);
     filenameLineEdit->setText("ising");
+    timeSeriesCheckBox->setChecked(false);
     ratioSpinBox->setValue(0.5);
     ratioCheckBox->click();
     wavelengthSpinBox->setValue(1);
+    correlationFreqSpinBox->setValue(0);
     
 }
 
@@ -404,4 +417,65 @@ bool ConstrainedParametersWidget::getAdvancedRandomise() const
 {
     return false;
 }
+
+SWEEPPARAMETER ConstrainedParametersWidget::getAdvancedParameter() const
+{
+    return SWEEPPARAMETER::Temperature;
+}
+
+bool ConstrainedParametersWidget::getGrid() const
+{
+    return false;
+}
+
+SWEEPPARAMETER ConstrainedParametersWidget::getGridParameter() const
+{
+    return SWEEPPARAMETER::Magnetic;
+}
+
+double ConstrainedParametersWidget::getGridStartValue() const
+{
+    return 0;
+}
+
+double ConstrainedParametersWidget::getGridStopValue() const
+{
+    return 0;
+}
+
+double ConstrainedParametersWidget::getGridStepValue() const
+{
+    return 0;
+}
+
+ALGORITHM ConstrainedParametersWidget::getAlgorithm() const
+{
+    return ALGORITHM::Metropolis;
+}
+
+unsigned int ConstrainedParametersWidget::getThreads() const
+{
+    return 1;
+}
+
+bool ConstrainedParametersWidget::getReplicaExchange() const
+{
+    return false;
+}
+
+bool ConstrainedParametersWidget::getAdaptLadder() const
+{
+    return false;
+}
+
+bool ConstrainedParametersWidget::getMultiSpin() const
+{
+    return false;
+}
+
+unsigned int ConstrainedParametersWidget::getCorrelationFreq() const
+{
+    Q_CHECK_PTR(correlationFreqSpinBox);
+    return correlationFreqSpinBox->value();
+}
          
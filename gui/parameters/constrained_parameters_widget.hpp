@@ -44,6 +44,18 @@ public:
     double getStopValue() const;
     double getStepValue() const;
     bool   getAdvancedRandomise() const;
+    SWEEPPARAMETER getAdvancedParameter() const;
+    bool   getGrid() const;
+    SWEEPPARAMETER getGridParameter() const;
+    double getGridStartValue() const;
+    double getGridStopValue() const;
+    double getGridStepValue() const;
+    ALGORITHM    getAlgorithm() const;
+    unsigned int getThreads() const;
+    bool         getReplicaExchange() const;
+    bool         getAdaptLadder() const;
+    bool         getMultiSpin() const;
+    unsigned int getCorrelationFreq() const;
 
     void setAdvancedValue(const double);
     
@@ -65,5 +77,6 @@ private:
     QCheckBox*      ratioCheckBox = new QCheckBox(this);
     QSpinBox*       wavelengthSpinBox = new QSpinBox(this);
     QCheckBox*      wavelengthCheckBox = new QCheckBox(this);
+    QSpinBox*       correlationFreqSpinBox = new QSpinBox(this);
 
 };
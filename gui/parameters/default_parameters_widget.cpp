@@ -12,11 +12,21 @@
     Q_CHECK_PTR(printFreqSpinBox);   \
     Q_CHECK_PTR(randomiseBtn);       \
     Q_CHECK_PTR(filenameLineEdit);   \
+    Q_CHECK_PTR(timeSeriesCheckBox); \
     Q_CHECK_PTR(advancedComboBox);   \
     Q_CHECK_PTR(startValueSpinBox);  \
     Q_CHECK_PTR(stepValueSpinBox);   \
     Q_CHECK_PTR(stopValueSpinBox);   \
-    Q_CHECK_PTR(magneticSpinBox);    
+    Q_CHECK_PTR(gridComboBox);       \
+    Q_CHECK_PTR(gridStartSpinBox);   \
+    Q_CHECK_PTR(gridStepSpinBox);    \
+    Q_CHECK_PTR(gridStopSpinBox);    \
+    Q_CHECK_PTR(magneticSpinBox);    \
+    Q_CHECK_PTR(algorithmComboBox);  \
+    Q_CHECK_PTR(threadsSpinBox);     \
+    Q_CHECK_PTR(replicaExchangeCheckBox); \
+    Q_CHECK_PTR(adaptLadderCheckBox); \
+    Q_CHECK_PTR(multiSpinCheckBox);
 
 
 
@@ -40,6 +50,7 @@ DefaultParametersWidget::DefaultParametersWidget(QWidget* parent)
     
     // add Box with Line Edits
     mainLayout->addWidget(createSystemBox());
+    mainLayout->addWidget(createAlgorithmBox());
     // mainLayout->addWidget(randomiseBtn);
     // mainLayout->addWidget(randomiseBtn, Qt::Alignment(Qt::AlignCenter));
     mainLayout->addWidget(createEquilBox());
@@ -58,6 +69,8 @@ DefaultParametersWidget::DefaultParametersWidget(QWidget* parent)
     connect( stepsProdSpinBox  , static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &DefaultParametersWidget::valueChanged );
     connect( stepsProdExponentSpinBox, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &DefaultParametersWidget::valueChanged );
     connect( printFreqSpinBox  , static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &DefaultParametersWidget::valueChanged );
+    connect( algorithmComboBox , static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &DefaultParametersWidget::valueChanged );
+    connect( threadsSpinBox    , static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &DefaultParametersWidget::valueChanged );
     
     connect( heightSpinBox     , static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &DefaultParametersWidget::valueChanged );
     connect( widthSpinBox      , static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &DefaultParametersWidget::valueChanged );
@@ -151,6 +164,43 @@ QGroupBox* DefaultParametersWidget::createSystemBox()
 
 
 
+QGroupBox* DefaultParametersWidget::createAlgorithmBox()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+    DEFAULT_PARAMETERS_WIDGET_ASSERT_ALL
+
+    // the group
+    QGroupBox* labelBox = new QGroupBox("Algorithm");
+
+    // set up the ComboBox, entries in the order of ALGORITHM:
+    algorithmComboBox->addItem("random single-spin Metropolis");
+    algorithmComboBox->addItem("checkerboard Metropolis sweeps");
+    algorithmComboBox->addItem("Wolff cluster updates");
+    algorithmComboBox->addItem("Swendsen-Wang cluster sweeps");
+    algorithmComboBox->addItem("n-fold way (rejection-free)");
+    algorithmComboBox->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+
+    threadsSpinBox->setMinimum(1);
+    threadsSpinBox->setMaximum(256);
+    threadsSpinBox->setSingleStep(1);
+    threadsSpinBox->setMinimumWidth(70);
+    threadsSpinBox->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    threadsSpinBox->setAlignment(Qt::AlignRight);
+
+    // the layout
+    QFormLayout* formLayout = new QFormLayout();
+    formLayout->setLabelAlignment(Qt::AlignLeft);
+    formLayout->addRow("update scheme", algorithmComboBox);
+    formLayout->addRow("threads", threadsSpinBox);
+
+    // set group layout
+    labelBox->setLayout(formLayout);
+
+    return labelBox;
+}
+
+
+
 QGroupBox* DefaultParametersWidget::createEquilBox()
 {
     qDebug() << __PRETTY_FUNCTION__;
@@ -295,10 +345,45 @@ QGroupBox* DefaultParametersWidget::createAdvancedOptionsBox()
     stepValueSpinBox->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
     stepValueSpinBox->setAlignment(Qt::AlignRight);
 
+    // set up the grid options, a second parameter varied from one range of runs to the next:
+    gridComboBox->addItem("none");
+    gridComboBox->addItem("T");
+    gridComboBox->addItem("J");
+    gridComboBox->addItem("B");
+
+    for( QDoubleSpinBox* spinBox : {gridStartSpinBox, gridStopSpinBox} )
+    {
+        spinBox->setDecimals(2);
+        spinBox->setSingleStep(0.1);
+        spinBox->setMinimum(-20);
+        spinBox->setMaximum(20);
+    }
+    gridStepSpinBox->setDecimals(2);
+    gridStepSpinBox->setSingleStep(0.1);
+    gridStepSpinBox->setMinimum(-1);
+    gridStepSpinBox->setMaximum(1);
+
+    for( QDoubleSpinBox* spinBox : {gridStartSpinBox, gridStepSpinBox, gridStopSpinBox} )
+    {
+        spinBox->setMinimumWidth(55);
+        spinBox->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+        spinBox->setAlignment(Qt::AlignRight);
+    }
+
     // set up advancedRandomiseCheckBox:
     advancedRandomiseCheckBox->setCheckable(true);
     advancedRandomiseCheckBox->setChecked(false);
 
+    // set up replica exchange check boxes:
+    replicaExchangeCheckBox->setCheckable(true);
+    replicaExchangeCheckBox->setChecked(false);
+    adaptLadderCheckBox->setCheckable(true);
+    adaptLadderCheckBox->setChecked(false);
+
+    // set up multi-spin coding check box:
+    multiSpinCheckBox->setCheckable(true);
+    multiSpinCheckBox->setChecked(false);
+
     
     // the layout 
     QFormLayout* formLayout = new QFormLayout();
@@ -320,7 +405,19 @@ QGroupBox* DefaultParametersWidget::createAdvancedOptionsBox()
     rangeOptions->addWidget(stopValueSpinBox);
     formLayout->addRow("start : step : end", rangeOptions);
 
+    formLayout->addRow("grid: second parameter", gridComboBox);
+
+    QHBoxLayout* gridOptions = new QHBoxLayout();
+    Q_CHECK_PTR(gridOptions);
+    gridOptions->addWidget(gridStartSpinBox);
+    gridOptions->addWidget(gridStepSpinBox);
+    gridOptions->addWidget(gridStopSpinBox);
+    formLayout->addRow("start : step : end", gridOptions);
+
     formLayout->addRow("randomise between runs", advancedRandomiseCheckBox);
+    formLayout->addRow("replica exchange (T only)", replicaExchangeCheckBox);
+    formLayout->addRow("adapt temperature ladder", adaptLadderCheckBox);
+    formLayout->addRow("64 replicas per run (multi-spin)", multiSpinCheckBox);
 
     advancedOptionsBox->setLayout(formLayout);
     return advancedOptionsBox;
@@ -343,12 +440,22 @@ void DefaultParametersWidget::setReadOnly(bool flag)
     printFreqSpinBox->setReadOnly(flag);
     randomiseBtn->setEnabled(!flag);
     filenameLineEdit->setReadOnly(flag);
+    timeSeriesCheckBox->setEnabled(!flag);
     advancedComboBox->setEnabled(!flag);
     startValueSpinBox->setReadOnly(flag);
     stepValueSpinBox->setReadOnly(flag);
     stopValueSpinBox->setReadOnly(flag);
+    gridComboBox->setEnabled(!flag);
+    gridStartSpinBox->setReadOnly(flag);
+    gridStepSpinBox->setReadOnly(flag);
+    gridStopSpinBox->setReadOnly(flag);
     magneticSpinBox->setReadOnly(flag);
     advancedRandomiseCheckBox->setEnabled(!flag);
+    replicaExchangeCheckBox->setEnabled(!flag);
+    adaptLadderCheckBox->setEnabled(!flag);
+    multiSpinCheckBox->setEnabled(!flag);
+    algorithmComboBox->setEnabled(!flag);
+    threadsSpinBox->setReadOnly(flag);
 }
 
 
@@ -377,12 +484,22 @@ void DefaultParametersWidget::setDefault()
     interactionSpinBox->setValue(1.0);
     temperatureSpinBox->setValue(1.0);
     filenameLineEdit->setText("ising");
+    timeSeriesCheckBox->setChecked(false);
     advancedComboBox->setCurrentIndex(0);
     startValueSpinBox->setValue(0);
     stepValueSpinBox->setValue(0.1);
     stopValueSpinBox->setValue(0);
+    gridComboBox->setCurrentIndex(0);
+    gridStartSpinBox->setValue(0);
+    gridStepSpinBox->setValue(0.1);
+    gridStopSpinBox->setValue(0);
     magneticSpinBox->setValue(0.0);
     advancedRandomiseCheckBox->setChecked(false);
+    replicaExchangeCheckBox->setChecked(false);
+    adaptLadderCheckBox->setChecked(false);
+    multiSpinCheckBox->setChecked(false);
+    algorithmComboBox->setCurrentIndex(ALGORITHM::Metropolis);
+    threadsSpinBox->setValue(std::max(1u, std::thread::hardware_concurrency()));
 
 }
 
@@ -464,5 +581,82 @@ bool DefaultParametersWidget::getAdvancedRandomise() const
     Q_CHECK_PTR(advancedRandomiseCheckBox);
     return advancedRandomiseCheckBox->isChecked();
 }
+
+SWEEPPARAMETER DefaultParametersWidget::getAdvancedParameter() const
+{
+    // the combo box lists T, J, B in the order of SWEEPPARAMETER
+    Q_CHECK_PTR(advancedComboBox);
+    return static_cast<SWEEPPARAMETER>(advancedComboBox->currentIndex());
+}
+
+bool DefaultParametersWidget::getGrid() const
+{
+    // a grid needs a second parameter that is not the one varied along each range
+    Q_CHECK_PTR(gridComboBox);
+    return gridComboBox->currentIndex() > 0 && getGridParameter() != getAdvancedParameter();
+}
+
+SWEEPPARAMETER DefaultParametersWidget::getGridParameter() const
+{
+    // the combo box lists none, T, J, B
+    Q_CHECK_PTR(gridComboBox);
+    return static_cast<SWEEPPARAMETER>(std::max(0, gridComboBox->currentIndex() - 1));
+}
+
+double DefaultParametersWidget::getGridStartValue() const
+{
+    Q_CHECK_PTR(gridStartSpinBox);
+    return gridStartSpinBox->value();
+}
+
+double DefaultParametersWidget::getGridStopValue() const
+{
+    Q_CHECK_PTR(gridStopSpinBox);
+    return gridStopSpinBox->value();
+}
+
+double DefaultParametersWidget::getGridStepValue() const
+{
+    Q_CHECK_PTR(gridStepSpinBox);
+    return gridStepSpinBox->value();
+}
+
+ALGORITHM DefaultParametersWidget::getAlgorithm() const
+{
+    Q_CHECK_PTR(algorithmComboBox);
+    return static_cast<ALGORITHM>(algorithmComboBox->currentIndex());
+}
+
+unsigned int DefaultParametersWidget::getThreads() const
+{
+    Q_CHECK_PTR(threadsSpinBox);
+    return threadsSpinBox->value();
+}
+
+bool DefaultParametersWidget::getReplicaExchange() const
+{
+    // replica exchange is only possible if the temperature is varied
+    Q_CHECK_PTR(replicaExchangeCheckBox);
+    Q_CHECK_PTR(advancedComboBox);
+    return replicaExchangeCheckBox->isChecked() && advancedComboBox->currentIndex() == 0;
+}
+
+bool DefaultParametersWidget::getAdaptLadder() const
+{
+    Q_CHECK_PTR(adaptLadderCheckBox);
+    return adaptLadderCheckBox->isChecked();
+}
+
+unsigned int DefaultParametersWidget::getCorrelationFreq() const
+{
+    return 0;
+}
+
+bool DefaultParametersWidget::getMultiSpin() const
+{
+    // 64 replicas in one lattice word, spin-flip mode only
+    Q_CHECK_PTR(multiSpinCheckBox);
+    return multiSpinCheckBox->isChecked() && ! getConstrained();
+}
                 
                 
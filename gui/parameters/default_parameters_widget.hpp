@@ -21,6 +21,8 @@
 #include <QIntValidator>
 #include <QSize>
 #include <limits>
+#include <thread>
+#include <algorithm>
 
 
 
@@ -44,6 +46,18 @@ public:
     double getStopValue() const;
     double getStepValue() const;
     bool   getAdvancedRandomise() const;
+    SWEEPPARAMETER getAdvancedParameter() const;
+    bool   getGrid() const;
+    SWEEPPARAMETER getGridParameter() const;
+    double getGridStartValue() const;
+    double getGridStopValue() const;
+    double getGridStepValue() const;
+    ALGORITHM    getAlgorithm() const;
+    unsigned int getThreads() const;
+    bool         getReplicaExchange() const;
+    bool         getAdaptLadder() const;
+    bool         getMultiSpin() const;
+    unsigned int getCorrelationFreq() const;
 
     void setAdvancedValue(const double);
     
@@ -58,6 +72,7 @@ protected:
     QGroupBox* createEquilBox();
     QGroupBox* createProdBox();
     QGroupBox* createAdvancedOptionsBox();
+    QGroupBox* createAlgorithmBox();
     
 private:
     QDoubleSpinBox* magneticSpinBox     = new QDoubleSpinBox(this);
@@ -67,6 +82,17 @@ private:
     QDoubleSpinBox* stopValueSpinBox    = new QDoubleSpinBox(this);
     QDoubleSpinBox* stepValueSpinBox    = new QDoubleSpinBox(this);
 
+    QComboBox*      gridComboBox        = new QComboBox(this);
+    QDoubleSpinBox* gridStartSpinBox    = new QDoubleSpinBox(this);
+    QDoubleSpinBox* gridStopSpinBox     = new QDoubleSpinBox(this);
+    QDoubleSpinBox* gridStepSpinBox     = new QDoubleSpinBox(this);
+
     QCheckBox*  advancedRandomiseCheckBox = new QCheckBox(this);
+    QCheckBox*  replicaExchangeCheckBox   = new QCheckBox(this);
+    QCheckBox*  adaptLadderCheckBox       = new QCheckBox(this);
+    QCheckBox*  multiSpinCheckBox         = new QCheckBox(this);
+
+    QComboBox*  algorithmComboBox   = new QComboBox(this);
+    QSpinBox*   threadsSpinBox      = new QSpinBox(this);
 
 };
@@ -4,21 +4,19 @@
 namespace enhance 
 {
     unsigned int    seed;
-    std::mt19937_64 rand_engine;
+    Xoshiro256      rand_engine;
 
 
     // random double from [a,b)
     double randomDouble(double a, double b)
     {
-        std::uniform_real_distribution<double> distribution(a,b);
-        return distribution(rand_engine);
+        return a + (b - a) * randomCanonical(rand_engine);
     }
 
     // random int from [a,b]
     int randomInt(int a, int b)
     {
-        std::uniform_int_distribution<int> intdistribution(a,b);
-        return intdistribution(rand_engine);
+        return a + static_cast<int>( randomBounded(static_cast<std::uint64_t>(b - a) + 1, rand_engine) );
     }
 
     
@@ -8,6 +8,7 @@
 #include <type_traits>
 #include <string>
 #include <sys/stat.h>
+#include "random.hpp"
 
 // to be able to pass my own class objects to a stream via << :
 template<typename T>
@@ -21,7 +22,7 @@ namespace enhance
 {
 
     extern unsigned int     seed;
-    extern std::mt19937_64  rand_engine;
+    extern Xoshiro256       rand_engine;    // master stream, engines of threads and replicas are split off it
 
     double randomDouble(double, double);
     int    randomInt(int, int);
@@ -40,19 +41,17 @@ namespace enhance
     static struct __random_iterator
     {
         template<typename T>
-        constexpr inline decltype(auto) operator() ( const T& _container ) const -> typename T::const_iterator
+        inline auto operator() ( const T& _container ) const -> typename T::const_iterator
         {
             static_assert( HaveRandomAccessIterator<T>::value, "T has no std::random_access_iterator_tag in __enhance::random_iterator::operator()" );
-            std::uniform_int_distribution<std::size_t> dist(0,_container.size()-1);
-            return std::cbegin(_container) + dist(rand_engine);
+            return std::cbegin(_container) + randomBounded(_container.size(), rand_engine);
         }
         
         template<typename T>
-        constexpr inline decltype(auto) operator() ( T& _container ) -> typename T::iterator
+        inline auto operator() ( T& _container ) -> typename T::iterator
         {
             static_assert( HaveRandomAccessIterator<T>::value, "T has no std::random_access_iterator_tag in __enhance::random_iterator::operator()" );
-            std::uniform_int_distribution<std::size_t> dist(0,_container.size()-1);
-            return std::begin(_container) + dist(rand_engine);
+            return std::begin(_container) + randomBounded(_container.size(), rand_engine);
         }
     } randomIterator __attribute__((unused));
 
@@ -0,0 +1,138 @@
+#include "fft.hpp"
+#include <cassert>
+#include <cmath>
+#include <utility>
+
+
+namespace enhance
+{
+
+    FFT::FFT(const std::size_t n)
+      : length(n),
+        padded(1)
+    {
+        assert( n > 0 );
+
+        const bool powerOfTwo = (n & (n - 1)) == 0;
+        const std::size_t minimum = powerOfTwo ? n : 2*n - 1;
+        while( padded < minimum ) padded *= 2;
+
+        for( std::size_t k = 0; k < padded / 2; ++k )
+        {
+            twiddles.push_back( std::polar(1.0, -2*M_PI*k / padded) );
+        }
+
+        if( powerOfTwo ) return;
+
+        // n^2 mod 2n keeps the phase of the chirp accurate for long transforms
+        for( std::size_t k = 0; k < n; ++k )
+        {
+            const std::size_t square = (k * k) % (2 * n);
+            chirp.push_back( std::polar(1.0, -M_PI*square / n) );
+        }
+        filter.assign(padded, Complex(0));
+        filter[0] = std::conj(chirp[0]);
+        for( std::size_t k = 1; k < n; ++k )
+        {
+            filter[k] = filter[padded - k] = std::conj(chirp[k]);
+        }
+        radix2(filter, false);
+    }
+
+
+
+    void FFT::transform(std::vector<Complex>& data) const
+    {
+        assert( data.size() == length );
+
+        if( chirp.empty() )
+        {
+            radix2(data, false);
+            return;
+        }
+
+        // Bluestein: X_k = chirp_k * sum_n (x_n chirp_n) conj(chirp_{k-n}), the sum is a convolution
+        std::vector<Complex> work(padded, Complex(0));
+        for( std::size_t k = 0; k < length; ++k ) work[k] = data[k] * chirp[k];
+        radix2(work, false);
+        for( std::size_t k = 0; k < padded; ++k ) work[k] *= filter[k];
+        radix2(work, true);
+        for( std::size_t k = 0; k < length; ++k ) data[k] = work[k] * chirp[k] / static_cast<double>(padded);
+    }
+
+
+
+    void FFT::radix2(std::vector<Complex>& data, const bool inverse) const
+    {
+        // unnormalised, data.size() == padded or == length if that is a power of two
+
+        const std::size_t n = data.size();
+        const std::size_t stride = padded / n;
+
+        for( std::size_t i = 1, j = 0; i < n; ++i )
+        {
+            std::size_t bit = n >> 1;
+            for( ; j & bit; bit >>= 1 ) j ^= bit;
+            j ^= bit;
+            if( i < j ) std::swap(data[i], data[j]);
+        }
+
+        for( std::size_t half = 1; half < n; half *= 2 )
+        {
+            const std::size_t step = stride * (n / (2*half));
+            for( std::size_t start = 0; start < n; start += 2*half )
+            {
+                for( std::size_t k = 0; k < half; ++k )
+                {
+                    const Complex w = inverse ? std::conj(twiddles[k*step]) : twiddles[k*step];
+                    const Complex odd = w * data[start + k + half];
+                    data[start + k + half] = data[start + k] - odd;
+                    data[start + k] += odd;
+                }
+            }
+        }
+    }
+
+
+
+    std::vector<std::complex<double>> realFFT2D(const std::vector<double>& data, const std::size_t width, const std::size_t height)
+    {
+        assert( data.size() == width * height );
+
+        using Complex = std::complex<double>;
+        const std::size_t half = width/2 + 1;
+        std::vector<Complex> spectrum(half * height);
+
+        // rows y and y+1 as one complex row z = a + i b, then A_k = (Z_k + conj Z_-k)/2, B_k = (Z_k - conj Z_-k)/2i
+        const FFT rows(width);
+        std::vector<Complex> row(width);
+        for( std::size_t y = 0; y < height; y += 2 )
+        {
+            const bool pair = y + 1 < height;
+            for( std::size_t x = 0; x < width; ++x )
+            {
+                row[x] = Complex(data[y*width + x], pair ? data[(y+1)*width + x] : 0);
+            }
+            rows.transform(row);
+            for( std::size_t k = 0; k < half; ++k )
+            {
+                const Complex Z = row[k];
+                const Complex mirrored = std::conj(row[(width - k) % width]);
+                spectrum[y*half + k] = 0.5 * (Z + mirrored);
+                if( pair ) spectrum[(y+1)*half + k] = Complex(0, -0.5) * (Z - mirrored);
+            }
+        }
+
+        const FFT columns(height);
+        std::vector<Complex> column(height);
+        for( std::size_t k = 0; k < half; ++k )
+        {
+            for( std::size_t y = 0; y < height; ++y ) column[y] = spectrum[y*half + k];
+            columns.transform(column);
+            for( std::size_t y = 0; y < height; ++y ) spectrum[y*half + k] = column[y];
+        }
+
+        return spectrum;
+    }
+
+}
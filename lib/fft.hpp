@@ -0,0 +1,43 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+
+namespace enhance
+{
+
+    // discrete Fourier transform X_k = sum_n x_n exp(-2 pi i k n / N) of a fixed length N in O(N log N):
+    // powers of two run an iterative radix-2 transform, all other lengths Bluestein's algorithm on top of one
+    // of twice the length. Everything that only depends on N is computed once in the constructor
+    class FFT
+    {
+    public:
+        using Complex = std::complex<double>;
+
+        explicit FFT(const std::size_t);
+
+        std::size_t size() const { return length; }
+
+        // in place, data.size() == size()
+        void transform(std::vector<Complex>&) const;
+
+    private:
+        void radix2(std::vector<Complex>&, const bool) const;
+
+        std::size_t length;
+        std::size_t padded;                 // length of the radix-2 transforms
+        std::vector<Complex> twiddles {};   // exp(-2 pi i k / padded), k < padded/2
+        std::vector<Complex> chirp {};      // Bluestein: exp(-pi i n^2 / length)
+        std::vector<Complex> filter {};     // Bluestein: transform of the conjugate chirp
+    };
+
+
+
+    // transform of a real width x height array stored row by row. Since F(-k) = conj F(k) only the half
+    // spectrum kx = 0 ... width/2 is returned, element (kx, ky) at ky*(width/2+1) + kx. Two rows at a time
+    // are transformed as the real and imaginary part of one complex row
+    std::vector<std::complex<double>> realFFT2D(const std::vector<double>&, const std::size_t, const std::size_t);
+
+}
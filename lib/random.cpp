@@ -0,0 +1,102 @@
+#include "random.hpp"
+#include <cstring>
+
+
+namespace enhance
+{
+
+    void Xoshiro256::seed(const std::uint64_t _seed)
+    {
+        // the state is filled by splitmix64, which never yields an all-zero state
+        std::uint64_t x = _seed;
+        for( auto& word : s )
+        {
+            std::uint64_t z = (x += 0x9e3779b97f4a7c15);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            word = z ^ (z >> 31);
+        }
+    }
+
+
+
+    void Xoshiro256::jump()
+    {
+        // equivalent to 2^128 calls of operator()
+        static constexpr std::uint64_t polynomial[4] = { 0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c };
+        jump(polynomial);
+    }
+
+
+
+    void Xoshiro256::longJump()
+    {
+        // equivalent to 2^192 calls of operator()
+        static constexpr std::uint64_t polynomial[4] = { 0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635 };
+        jump(polynomial);
+    }
+
+
+
+    Xoshiro256 Xoshiro256::split()
+    {
+        // returns a copy of the current stream and jumps ahead, so that the two never overlap
+        Xoshiro256 stream = *this;
+        jump();
+        return stream;
+    }
+
+
+
+    void Xoshiro256::jump(const std::uint64_t (&polynomial)[4])
+    {
+        std::uint64_t t[4] {};
+        for( const auto word : polynomial )
+        {
+            for( int b = 0; b < 64; ++b )
+            {
+                if( word & (std::uint64_t{1} << b) )
+                {
+                    for( int i = 0; i < 4; ++i ) t[i] ^= s[i];
+                }
+                operator()();
+            }
+        }
+        for( int i = 0; i < 4; ++i ) s[i] = t[i];
+    }
+
+
+
+    void Xoshiro256x4::seed(Xoshiro256& source)
+    {
+        // every lane continues a stream split off the source, the lanes are separated by jump()
+        for( std::size_t lane = 0; lane < lanes; ++lane )
+        {
+            const Xoshiro256 stream = source.split();
+            for( std::size_t word = 0; word < 4; ++word ) s[word][lane] = stream.s[word];
+        }
+    }
+
+
+
+    void Xoshiro256x4::fillCanonical(double* out, const std::size_t n)
+    {
+        // uniform doubles in [0,1): the upper 52 bits become the mantissa of a number in [1,2),
+        // which avoids the integer to double conversion that has no vector instruction before AVX-512
+        constexpr std::size_t blockSize = 64;
+        std::uint64_t block[blockSize];
+        for( std::size_t i = 0; i < n; i += blockSize )
+        {
+            const std::size_t m = n - i < blockSize ? n - i : blockSize;
+            fill(block, m);
+            for( std::size_t j = 0; j < m; ++j )
+            {
+                const std::uint64_t bits = (block[j] >> 12) | 0x3ff0000000000000;
+                double value;
+                std::memcpy(&value, &bits, sizeof(value));
+                out[i + j] = value - 1.0;
+            }
+        }
+    }
+
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+
+namespace enhance
+{
+
+    // xoshiro256** (Blackman & Vigna), a small and fast generator with a period of 2^256-1.
+    // jump() advances the state by 2^128 draws, so split() hands out non-overlapping streams
+    // for threads and replicas. Fulfils the UniformRandomBitGenerator requirements.
+    class Xoshiro256
+    {
+    public:
+        using result_type = std::uint64_t;
+
+        explicit Xoshiro256(const std::uint64_t _seed = 0) { seed(_seed); }
+
+        void seed(const std::uint64_t);
+        void jump();
+        void longJump();
+        Xoshiro256 split();
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        inline result_type operator()()
+        {
+            const std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+            const std::uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+
+        static constexpr std::uint64_t rotl(const std::uint64_t x, const int k) { return (x << k) | (x >> (64 - k)); }
+
+    private:
+        friend class Xoshiro256x4;
+
+        void jump(const std::uint64_t (&)[4]);
+
+        std::uint64_t s[4] {};
+    };
+
+
+
+    // four interleaved xoshiro256** streams for bulk generation: the lanes are independent of
+    // each other, so the loop in fill() is vectorised by the compiler. Every lane takes over the
+    // state of a stream split off the source, so the lanes never overlap. Only pays off where whole
+    // blocks of numbers are consumed, single draws are cheapest from Xoshiro256::operator().
+    class Xoshiro256x4
+    {
+    public:
+        Xoshiro256x4() = default;
+        explicit Xoshiro256x4(Xoshiro256& source) { seed(source); }
+
+        void seed(Xoshiro256&);
+        inline void fill(std::uint64_t*, const std::size_t);
+        void fillCanonical(double*, const std::size_t);
+
+    private:
+        static constexpr std::size_t lanes {4};
+
+        alignas(32) std::uint64_t s[4][lanes] {};       // s[word][lane]
+    };
+
+
+
+    inline void Xoshiro256x4::fill(std::uint64_t* out, const std::size_t n)
+    {
+        // defined here, so that it is compiled for the instruction set of the caller. The state is held
+        // in local copies while generating, so that the compiler does not have to assume out aliases it
+        // and can keep all lanes in vector registers
+        std::uint64_t s0[lanes], s1[lanes], s2[lanes], s3[lanes], result[lanes];
+        for( std::size_t l = 0; l < lanes; ++l )
+        {
+            s0[l] = s[0][l];  s1[l] = s[1][l];  s2[l] = s[2][l];  s3[l] = s[3][l];
+        }
+
+        // one step of all lanes, the same arithmetic as Xoshiro256::operator(); the multiplications
+        // are written as shifts, there is no 64 bit vector multiply before AVX-512
+        auto step = [&]()
+        {
+            for( std::size_t l = 0; l < lanes; ++l )
+            {
+                const std::uint64_t r = Xoshiro256::rotl((s1[l] << 2) + s1[l], 7);
+                result[l] = (r << 3) + r;
+                const std::uint64_t t = s1[l] << 17;
+                s2[l] ^= s0[l];
+                s3[l] ^= s1[l];
+                s1[l] ^= s2[l];
+                s0[l] ^= s3[l];
+                s2[l] ^= t;
+                s3[l] = Xoshiro256::rotl(s3[l], 45);
+            }
+        };
+
+        std::size_t i = 0;
+        for( ; i + lanes <= n; i += lanes )
+        {
+            step();
+            for( std::size_t l = 0; l < lanes; ++l ) out[i + l] = result[l];
+        }
+        if( i < n )
+        {
+            step();
+            for( std::size_t l = 0; i < n; ++i, ++l ) out[i] = result[l];
+        }
+
+        for( std::size_t l = 0; l < lanes; ++l )
+        {
+            s[0][l] = s0[l];  s[1][l] = s1[l];  s[2][l] = s2[l];  s[3][l] = s3[l];
+        }
+    }
+
+
+
+    __extension__ typedef unsigned __int128 uint128_t;
+
+    // uniform integer in [0, range) from one multiplication (Lemire 2019): the rejection zone is
+    // smaller than range/2^64, so the division is only evaluated when the cheap test fails
+    template<typename ENGINE>
+    inline std::uint64_t randomBounded(const std::uint64_t range, ENGINE& engine)
+    {
+        uint128_t m = static_cast<uint128_t>(engine()) * range;
+        std::uint64_t low = static_cast<std::uint64_t>(m);
+        if( low < range )
+        {
+            const std::uint64_t threshold = -range % range;
+            while( low < threshold )
+            {
+                m = static_cast<uint128_t>(engine()) * range;
+                low = static_cast<std::uint64_t>(m);
+            }
+        }
+        return static_cast<std::uint64_t>(m >> 64);
+    }
+
+
+
+    // uniform double in [0,1) from the upper 53 bits
+    template<typename ENGINE>
+    inline double randomCanonical(ENGINE& engine)
+    {
+        return static_cast<double>(engine() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+}
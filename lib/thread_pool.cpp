@@ -0,0 +1,93 @@
+#include "thread_pool.hpp"
+
+
+namespace enhance
+{
+
+    ThreadPool::ThreadPool(const unsigned int threads)
+    {
+        // the calling thread is thread 0, so only threads-1 workers are needed
+        for( unsigned int t = 1; t < threads; ++t )
+        {
+            workers.emplace_back( &ThreadPool::work, this, t );
+        }
+    }
+
+
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wakeup.notify_all();
+        for( auto& W : workers )
+        {
+            W.join();
+        }
+    }
+
+
+
+    void ThreadPool::parallel_for(const std::size_t n, const std::function<void(std::size_t, unsigned int)>& _body)
+    {
+        if( workers.empty() || n < 2 )
+        {
+            for( std::size_t i = 0; i < n; ++i ) _body(i, 0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            body = &_body;
+            tasks = n;
+            nextTask.store(0);
+            busy = workers.size();
+            ++generation;
+        }
+        wakeup.notify_all();
+
+        runTasks(0);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]{ return busy == 0; });
+        body = nullptr;
+    }
+
+
+
+    void ThreadPool::work(const unsigned int thread)
+    {
+        unsigned long seen = 0;
+        while( true )
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait(lock, [&]{ return stop || generation != seen; });
+                if( stop ) return;
+                seen = generation;
+            }
+
+            runTasks(thread);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if( --busy == 0 ) finished.notify_one();
+            }
+        }
+    }
+
+
+
+    void ThreadPool::runTasks(const unsigned int thread)
+    {
+        // indices are handed out one by one, so faster threads simply take more of them
+        std::size_t i;
+        while( (i = nextTask.fetch_add(1)) < tasks )
+        {
+            (*body)(i, thread);
+        }
+    }
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace enhance
+{
+
+    // a fixed set of worker threads that are kept alive between calls, so that
+    // short parallel loops (e.g. one half-sweep of the lattice) do not pay for
+    // thread creation; the calling thread takes part as thread 0
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(const unsigned int);
+        ThreadPool(const ThreadPool&) = delete;
+        void operator=(const ThreadPool&) = delete;
+        ~ThreadPool();
+
+        unsigned int size() const { return workers.size() + 1; }
+
+        // calls body(index, thread) for every index in [0,n) and returns when all calls are done
+        void parallel_for(const std::size_t, const std::function<void(std::size_t, unsigned int)>&);
+
+    private:
+        void work(const unsigned int);
+        void runTasks(const unsigned int);
+
+        std::vector<std::thread>  workers {};
+        std::mutex                mutex {};
+        std::condition_variable   wakeup {};
+        std::condition_variable   finished {};
+
+        const std::function<void(std::size_t, unsigned int)>* body {nullptr};
+        std::size_t               tasks {0};
+        std::atomic<std::size_t>  nextTask {0};
+        unsigned long             generation {0};
+        unsigned int              busy {0};
+        bool                      stop {false};
+    };
+
+}
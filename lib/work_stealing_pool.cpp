@@ -0,0 +1,74 @@
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <thread>
+
+
+namespace enhance
+{
+
+    WorkStealingPool::WorkStealingPool(const unsigned int threads)
+    {
+        for( unsigned int t = 0; t < std::max(threads, 1u); ++t )
+        {
+            queues.emplace_back( std::make_unique<Queue>() );
+        }
+    }
+
+
+
+    void WorkStealingPool::run(std::vector<Task> tasks)
+    {
+        // tasks are long compared to starting a thread, so the threads only live for one call
+
+        for( std::size_t i = 0; i < tasks.size(); ++i )
+        {
+            queues[i % queues.size()]->tasks.push_back( std::move(tasks[i]) );
+        }
+
+        std::vector<std::thread> workers;
+        for( unsigned int t = 1; t < std::min<std::size_t>(queues.size(), tasks.size()); ++t )
+        {
+            workers.emplace_back( &WorkStealingPool::work, this, t );
+        }
+
+        work(0);
+
+        for( auto& W : workers )
+        {
+            W.join();
+        }
+    }
+
+
+
+    void WorkStealingPool::work(const unsigned int thread)
+    {
+        Task task;
+        while( take(thread, task) )
+        {
+            task(thread);
+        }
+    }
+
+
+
+    bool WorkStealingPool::take(const unsigned int thread, Task& task)
+    {
+        // own queue first, then the others starting with the next thread;
+        // no task is added during run(), so all queues empty means all tasks are taken
+
+        for( std::size_t k = 0; k < queues.size(); ++k )
+        {
+            Queue& Q = *queues[(thread + k) % queues.size()];
+            std::lock_guard<std::mutex> lock(Q.mutex);
+            if( ! Q.tasks.empty() )
+            {
+                task = std::move(Q.tasks.front());
+                Q.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+}
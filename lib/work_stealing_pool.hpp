@@ -0,0 +1,44 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+namespace enhance
+{
+
+    // runs a list of independent, long tasks (e.g. the points of a parameter sweep) on a fixed number of threads.
+    // Every thread has its own queue, the tasks are dealt out round-robin in the given order and every thread
+    // works through its queue from the front. A thread whose queue has run empty steals the front task of the
+    // next non-empty queue, so tasks given first are started first; the calling thread takes part as thread 0
+    class WorkStealingPool
+    {
+    public:
+        using Task = std::function<void(unsigned int)>;
+
+        explicit WorkStealingPool(const unsigned int);
+        WorkStealingPool(const WorkStealingPool&) = delete;
+        void operator=(const WorkStealingPool&) = delete;
+
+        unsigned int size() const { return queues.size(); }
+
+        // calls task(thread) for every task and returns when all calls are done
+        void run(std::vector<Task>);
+
+    private:
+        struct Queue
+        {
+            std::mutex        mutex {};
+            std::deque<Task>  tasks {};
+        };
+
+        void work(const unsigned int);
+        bool take(const unsigned int, Task&);
+
+        std::vector<std::unique_ptr<Queue>> queues {};
+    };
+
+}
@@ -6,11 +6,61 @@
 
 
 #include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
 
-#define isingLOG(x) {std::clog << "[LOG] "; do { std::clog << x; } while (0); std::clog << '\n';}
+
+// log lines are put together first and written in one piece under a lock, so that the lines of
+// concurrent workers (sweeps, replica exchange) do not interleave
+inline void isingWriteLine(std::ostream& stream, const std::string& line)
+{
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> lock(mutex);
+    stream << line << '\n';
+}
+
+#define isingLOG(x) {std::ostringstream isingLine; isingLine << "[LOG] "; do { isingLine << x; } while (0); isingWriteLine(std::clog, isingLine.str());}
 
 #ifndef NDEBUG
-    #define isingDEBUG(x) {std::cerr << "[DEBUG] "; do { std::cerr << x; } while (0); std::cerr << '\n';}
+    #define isingDEBUG(x) {std::ostringstream isingLine; isingLine << "[DEBUG] "; do { isingLine << x; } while (0); isingWriteLine(std::cerr, isingLine.str());}
 #else
     #define isingDEBUG(x)
 #endif
+
+
+// update schemes of the Monte Carlo engine
+enum ALGORITHM { Metropolis, Checkerboard, Wolff, SwendsenWang, NFoldWay };
+
+// parameter varied along a sweep, in the order of the GUI's selection
+enum SWEEPPARAMETER { Temperature, Interaction, Magnetic };
+
+
+// the simulation engine is also built without Qt (ising_core, ising-cli, compiled with ISING_NO_QT).
+// There qDebug() is silent as with QT_NO_DEBUG_OUTPUT, qInfo() writes to std::clog and Q_CHECK_PTR asserts.
+#ifdef ISING_NO_QT
+    #include <cassert>
+
+    class DebugStream
+    {
+    public:
+        explicit DebugStream(std::ostream* _stream) : stream(_stream) {}
+        DebugStream(const DebugStream&) = delete;
+        void operator=(const DebugStream&) = delete;
+        ~DebugStream() { if( stream ) isingWriteLine(*stream, line.str()); }
+
+        template<typename T>
+        DebugStream& operator<<(const T& value) { if( stream ) line << value << ' '; return *this; }
+
+    private:
+        std::ostream*      stream {nullptr};
+        std::ostringstream line {};
+    };
+
+    #define qDebug() DebugStream(nullptr)
+    #define qInfo() DebugStream(&std::clog)
+    #define Q_CHECK_PTR(ptr) assert(ptr)
+    #define Q_NULLPTR nullptr
+#else
+    #include <QDebug>
+#endif
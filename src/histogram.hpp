@@ -4,6 +4,12 @@
 #include <iomanip>
 #include <fstream>
 #include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 
 template <typename T>
@@ -14,12 +20,17 @@ struct Bin
     T min = 0;
     T max = 0;
     double counter = 0;
+    unsigned long entries = 0;      // number of add_data() calls that went into the bin
 
     // check if _val fits and if it does, increment counter
     constexpr inline bool operator()(const T& _val, const double& _increment = 1)
     {
         const bool increase = _val > min && _val <= max;
-        if( increase ) counter += _increment;
+        if( increase )
+        {
+            counter += _increment;
+            ++entries;
+        }
         return increase;
     }
 
@@ -47,30 +58,40 @@ struct Bin
 
 /***************************************************************************/
 
+// Dense histogram: bin i holds the values in (origin + (i-1/2) width, origin + (i+1/2) width], so a value is
+// mapped to its bin in O(1) and the bins are kept in order of position.
+// Histogram(width) grows its range with the data, Histogram(min, max, width) keeps the bins around min to max
+// and ignores values outside of them. Either way a histogram has at most maxBins bins: values that would need
+// more, and values that are not finite, are counted as outliers().
+// Bins are only printed once data has been added to them (Bin::entries > 0); users iterating over the bins
+// skip the empty ones the same way.
+// A histogram is not thread safe: parallel samplers fill one histogram per thread with the same binning and
+// merge() them when they are done.
 template <typename T>
 struct Histogram
 {
     typedef T type;
 
     Histogram(const T&);
+    Histogram(const T&, const T&, const T&);
 
     void add_data(const T&);
     void add_data(const T&, const double&);
-    auto get_data(const T&);
+    auto get_data(const T&) const;
+    void merge(const Histogram&);
 
-    inline std::string formatted_string();
+    inline std::string formatted_string() const;
     inline void        print_to_file (const std::string&) const;
-    void sort_bins() { std::sort(std::begin(bins), std::end(bins), [](auto& b1, auto& b2){ return b1.min < b2.min; }); }
 
     inline double meanHeight() const;
-    inline auto populated_bins() const { return std::count_if(bins.cbegin(), bins.cend(), [](auto B) { return B.counter > 0;} ); }
+    inline auto populated_bins() const { return std::count_if(bins.cbegin(), bins.cend(), [](const auto& B) { return B.entries > 0;} ); }
     inline auto num_bins()       const { return bins.size(); }
-    inline auto minimum()        const { return min; }
-    inline auto maximum()        const { return max; }
+    inline auto minimum()        const { return bins.empty() ? static_cast<T>(0) : bins.front().min; }
+    inline auto maximum()        const { return bins.empty() ? static_cast<T>(0) : bins.back().max; }
     inline auto reset(const double& i = 0) { std::for_each(bins.begin(), bins.end(), [&i](auto& B) { B.counter = i;} ); }
-    inline auto clear() { bins.clear(); min = 0; max = 0; }
-    inline void shift(const T& _shift) { std::for_each(std::begin(bins), std::end(bins), [&_shift](auto& B) { B.counter -= _shift; }); }
-    // inline auto normalise(const double& v) { std::for_each(bins.begin(), bins.end(), [&v](auto& B) { B.counter /= v; }); }
+    inline auto clear() { if( ! fixed ) bins.clear(); reset(); for( auto& B : bins ) B.entries = 0; outside = 0; }
+    inline void shift(const T& _shift) { std::for_each(std::begin(bins), std::end(bins), [&_shift](auto& B) { if( B.entries > 0 ) B.counter -= _shift; }); }
+    inline auto outliers()       const { return outside; }
     
     inline auto begin()          const   { return bins.begin(); }
     inline auto begin()                  { return bins.begin(); }
@@ -79,10 +100,18 @@ struct Histogram
     inline auto end()                    { return bins.end(); }
     inline auto cend()           const   { return bins.cend(); }
     
+    static constexpr long maxBins {1L << 20};
+
 protected:
-    T min;
-    T max;
-    const T bin_width;
+    bool index(const T&, long&) const;
+    Bin<T> makeBin(const long) const;
+    Bin<T>* find(const long);
+
+    T origin {0};
+    T bin_width;
+    bool fixed {false};
+    long first {0};                 // index of bins.front()
+    unsigned long outside {0};      // values that missed the fixed range
     std::vector<Bin<T>> bins {};
     
 };
@@ -90,34 +119,89 @@ protected:
 
 template<typename T>
 inline Histogram<T>::Histogram(const T& width)
- : min(0)
- , max(0)
- , bin_width(width)
-{}
+ : bin_width(width)
+{
+    if( ! (width > 0) ) throw std::invalid_argument("histogram bin width must be positive");
+}
 
 
 
 template<typename T>
-inline void Histogram<T>::add_data(const T& _data)
+inline Histogram<T>::Histogram(const T& _min, const T& _max, const T& width)
+ : origin(_min),
+   bin_width(width),
+   fixed(true)
+{
+    if( ! (width > 0) || _max < _min ) throw std::invalid_argument("histogram range is empty");
+    long last = 0;
+    if( ! index(_max, last) || last >= maxBins ) throw std::length_error("histogram range has too many bins");
+    for( long i = 0; i <= last; ++i ) bins.push_back( makeBin(i) );
+}
+
+
+
+template<typename T>
+inline bool Histogram<T>::index(const T& _data, long& i) const
+{
+    // number i of the bin of _data, false if _data is not finite or too far from origin for any range
+
+    const double x = std::ceil( (static_cast<double>(_data) - origin) / bin_width - 0.5 );
+    if( ! (std::abs(x) < 9007199254740992.0) ) return false;     // 2^53, also NaN
+    i = static_cast<long>(x);
+    return true;
+}
+
+
+
+template<typename T>
+inline Bin<T> Histogram<T>::makeBin(const long i) const
+{
+    Bin<T> B;
+    B.min = origin + (i - 0.5) * bin_width;
+    B.max = origin + (i + 0.5) * bin_width;
+    return B;
+}
+
+
+
+template<typename T>
+inline Bin<T>* Histogram<T>::find(const long i)
 {
-    bool found_bin = false;
-    for( auto& B : bins )
+    // bin number i, nullptr outside of a fixed range; an open range is extended up to it unless that
+    // takes more than maxBins bins
+
+    if( ! fixed && ! bins.empty() )
     {
-        if( B(_data) )
-        {
-            found_bin = true;
-            break;
-        } 
+        const long last = first + static_cast<long>(bins.size()) - 1;
+        if( std::max(last, i) - std::min(first, i) >= maxBins ) return nullptr;
+    }
+    if( bins.empty() && ! fixed )
+    {
+        first = i;
+        bins.push_back( makeBin(i) );
     }
-    if( ! found_bin )
+    if( i < first )
     {
-        bins.emplace_back();
-        bins.back().min = _data - bin_width/2;
-        bins.back().max = _data + bin_width/2;
-        bins.back().counter = 1;
-        if( bins.back().min < min ) min = bins.back().min;
-        if( bins.back().max > max ) max = bins.back().max;
-    }   
+        if( fixed ) return nullptr;
+        std::vector<Bin<T>> front;
+        for( long j = i; j < first; ++j ) front.push_back( makeBin(j) );
+        bins.insert(bins.begin(), front.begin(), front.end());
+        first = i;
+    }
+    while( i >= first + static_cast<long>(bins.size()) )
+    {
+        if( fixed ) return nullptr;
+        bins.push_back( makeBin(first + bins.size()) );
+    }
+    return &bins[i - first];
+}
+
+
+
+template<typename T>
+inline void Histogram<T>::add_data(const T& _data)
+{
+    add_data(_data, 1);
 }
 
 
@@ -125,52 +209,66 @@ inline void Histogram<T>::add_data(const T& _data)
 template<typename T>
 inline void Histogram<T>::add_data(const T& _data,  const double& _increment)
 {
-    bool found_bin = false;
-    for( auto& B : bins )
+    long i = 0;
+    Bin<T>* B = index(_data, i) ? find(i) : nullptr;
+    if( B == nullptr )
     {
-        if( B(_data, _increment) )
-        {
-            found_bin = true;
-            break;
-        } 
+        ++outside;
+        return;
     }
-    if( ! found_bin )
+    B->counter += _increment;
+    ++B->entries;
+}
+
+
+
+template<typename T>
+inline auto Histogram<T>::get_data(const T& _data) const
+{
+    long i = 0;
+    if( ! index(_data, i) || (i -= first) < 0 || i >= static_cast<long>(bins.size()) || bins[i].entries == 0 )
     {
-        bins.emplace_back();
-        bins.back().min = _data - bin_width/2;
-        bins.back().max = _data + bin_width/2;
-        bins.back().counter = _increment;
-        if( bins.back().min < min ) min = bins.back().min;
-        if( bins.back().max > max ) max = bins.back().max;
-    }  
+        throw std::range_error("out of range in histogram<T>::get_data() ! ");
+    }
+    return bins[i].counter;
 }
 
 
 
 template<typename T>
-inline auto Histogram<T>::get_data(const T& _data)
+inline void Histogram<T>::merge(const Histogram& other)
 {
-    bool found = false;
-    for( auto& B: bins )
+    // adds the bins of a histogram with the same bin width and origin
+
+    if( other.bin_width != bin_width || other.origin != origin )
+    {
+        throw std::invalid_argument("merging histograms of different binning");
+    }
+    outside += other.outside;
+    for( std::size_t i = 0; i < other.bins.size(); ++i )
     {
-        if( B[_data] )
+        const Bin<T>& B = other.bins[i];
+        if( B.entries == 0 ) continue;
+        Bin<T>* target = find( other.first + static_cast<long>(i) );
+        if( target == nullptr )
         {
-            return B.counter;
-            found = true;
+            outside += B.entries;
+            continue;
         }
+        target->counter += B.counter;
+        target->entries += B.entries;
     }
-    if( found == false ) throw std::range_error("out of range in histogram<T>::get_data() ! ");
-    return static_cast<T>(0);
 }
 
 
 
 template<typename T>
-inline std::string Histogram<T>::formatted_string()
+inline std::string Histogram<T>::formatted_string() const
 {
     std::ostringstream STREAM;
-    for( auto& B : bins )
+    for( const auto& B : bins )
     {
+        if( B.entries == 0 ) continue;
         STREAM << std::setw(10) << std::setprecision(4) << B.position()
                << std::setw(20) << std::setprecision(4) << B.counter << '\n';
     }
@@ -192,5 +290,5 @@ inline void Histogram<T>::print_to_file (const std::string& _filename) const
 template<typename T>
 inline double Histogram<T>::meanHeight() const
 {
-    return std::accumulate(bins.cbegin(), bins.cend(), 0.0, [](float i, auto B) { return i + B.counter; } ) / populated_bins();
+    return std::accumulate(bins.cbegin(), bins.cend(), 0.0, [](double i, const auto& B) { return i + B.counter; } ) / populated_bins();
 }
@@ -0,0 +1,46 @@
+#include "acceptance_table.hpp"
+#include "definitions.hpp"
+#include <cmath>
+#include <limits>
+
+
+
+std::uint64_t AcceptanceTable::scaledProbability(const double probability)
+{
+    // probability in [0,1] as threshold for a 64 bit random number, 1 saturates
+    return probability >= 1 ? std::numeric_limits<std::uint64_t>::max()
+                            : static_cast<std::uint64_t>( std::ldexp(probability, 64) );
+}
+
+
+
+bool AcceptanceTable::update(const double J, const double B, const double T)
+{
+    // rebuild the table if the parameters have changed since the last call,
+    // returns true if the table was rebuilt
+
+    if( valid && J == interaction && B == magnetic && T == temperature ) return false;
+
+    interaction = J;
+    magnetic = B;
+    temperature = T;
+    valid = true;
+
+    for( int dSpins = -maxSpins; dSpins <= maxSpins; dSpins += 2 )
+    {
+        for( int dBonds = -maxBonds; dBonds <= maxBonds; ++dBonds )
+        {
+            Entry& E = entries[index(dBonds, dSpins)];
+            const double probability = std::exp( (J * dBonds + B * dSpins) / T );
+            E.always = probability >= 1;
+            // probability < 1 here, scaled to the range of a 64 bit random number
+            E.threshold = E.always ? 0 : static_cast<std::uint64_t>( std::ldexp(probability, 64) );
+        }
+    }
+
+    clusterBond = scaledProbability( -std::expm1(-2 * std::abs(J) / T) );
+    ghostBond   = scaledProbability( -std::expm1(-2 * std::abs(B) / T) );
+
+    isingDEBUG("acceptance table: " << "rebuilt for J = " << J << ", B = " << B << ", T = " << T)
+    return true;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+
+// Metropolis acceptance probabilities min(1, exp(-dE/T)) for every energy change that a move
+// on the square lattice with nearest neighbour interaction can produce:
+//     dE = -J * dBonds - B * dSpins
+// with dBonds the change of sum_<ij> s_i*s_j and dSpins the change of sum_i s_i.
+// The probabilities are stored as thresholds for a raw 64 bit random number, so that a decision
+// is a single integer comparison; moves that do not increase the energy need no random number at all.
+// The table also holds the bond probabilities of the Wolff cluster update, which depend on the same parameters.
+class AcceptanceTable
+{
+public:
+    static constexpr int maxBonds = 16;     // |dBonds| of a spin pair exchange is at most 2*(4+4)
+    static constexpr int maxSpins = 2;      // |dSpins| of a single spin flip
+
+    bool update(const double, const double, const double);
+
+    inline bool alwaysAccepted(const int, const int) const;
+    inline std::uint64_t threshold(const int, const int) const;
+    inline double        probability(const int, const int) const;
+
+    template<typename ENGINE>
+    inline bool accept(const int, const int, ENGINE&) const;
+    template<typename ENGINE>
+    inline bool accept(const int, const int, const double, ENGINE&) const;
+
+    // Wolff cluster update: thresholds for 1 - exp(-2|J|/T) (bond between neighbours)
+    // and 1 - exp(-2|B|/T) (bond to the ghost spin)
+    std::uint64_t clusterBondThreshold() const { return clusterBond; }
+    std::uint64_t ghostBondThreshold() const { return ghostBond; }
+
+private:
+    struct Entry
+    {
+        bool          always {true};       // dE <= 0
+        std::uint64_t threshold {0};       // exp(-dE/T) * 2^64 if dE > 0
+    };
+
+    static constexpr unsigned int bondEntries = 2 * maxBonds + 1;
+    static constexpr unsigned int spinEntries = maxSpins + 1;     // dSpins is even: -2, 0, +2
+
+    inline static unsigned int index(const int, const int);
+    static std::uint64_t scaledProbability(const double);
+
+    std::array<Entry, bondEntries * spinEntries> entries {};
+    std::uint64_t clusterBond {0};
+    std::uint64_t ghostBond {0};
+
+    // parameters the table was built for
+    double interaction {0};
+    double magnetic {0};
+    double temperature {0};
+    bool   valid {false};
+};
+
+
+
+inline unsigned int AcceptanceTable::index(const int dBonds, const int dSpins)
+{
+    assert( dBonds >= -maxBonds && dBonds <= maxBonds );
+    assert( dSpins >= -maxSpins && dSpins <= maxSpins && dSpins % 2 == 0 );
+    return (dSpins / 2 + 1) * bondEntries + (dBonds + maxBonds);
+}
+
+
+
+inline bool AcceptanceTable::alwaysAccepted(const int dBonds, const int dSpins) const
+{
+    return entries[index(dBonds, dSpins)].always;
+}
+
+
+
+inline std::uint64_t AcceptanceTable::threshold(const int dBonds, const int dSpins) const
+{
+    return entries[index(dBonds, dSpins)].threshold;
+}
+
+
+
+inline double AcceptanceTable::probability(const int dBonds, const int dSpins) const
+{
+    const Entry& E = entries[index(dBonds, dSpins)];
+    return E.always ? 1.0 : std::ldexp(static_cast<double>(E.threshold), -64);
+}
+
+
+
+template<typename ENGINE>
+inline bool AcceptanceTable::accept(const int dBonds, const int dSpins, ENGINE& engine) const
+{
+    // engine() has to deliver uniformly distributed 64 bit numbers
+    const Entry& E = entries[index(dBonds, dSpins)];
+    return E.always || engine() < E.threshold;
+}
+
+
+
+template<typename ENGINE>
+inline bool AcceptanceTable::accept(const int dBonds, const int dSpins, const double proposalRatio, ENGINE& engine) const
+{
+    // Metropolis-Hastings decision min(1, exp(-dE/T) * proposalRatio) for moves with asymmetric proposals,
+    // proposalRatio = q(reverse)/q(move) is the probability to propose the reverse move over that to propose the move
+    if( proposalRatio == 1 ) return accept(dBonds, dSpins, engine);
+
+    const double P = probability(dBonds, dSpins) * proposalRatio;
+    return P >= 1 || std::ldexp(static_cast<double>(engine()), -64) < P;
+}
@@ -0,0 +1,226 @@
+#include "correlation_accumulator.hpp"
+#include <cmath>
+#include <iomanip>
+
+
+
+CorrelationAccumulator::CorrelationAccumulator()
+{
+    thread = std::thread(&CorrelationAccumulator::work, this);
+}
+
+
+
+CorrelationAccumulator::~CorrelationAccumulator()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+        pending.clear();
+    }
+    queued.notify_one();
+    space.notify_all();
+    thread.join();
+}
+
+
+
+void CorrelationAccumulator::add(std::vector<double> spins, const unsigned long _width, const unsigned long _height)
+{
+    // from the simulation thread, returns at once unless maxPending configurations are waiting already
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        space.wait(lock, [this]{ return quit || pending.size() < maxPending; });
+        if( quit ) return;
+        pending.push_back( Lattice{std::move(spins), _width, _height} );
+    }
+    queued.notify_one();
+}
+
+
+
+void CorrelationAccumulator::wait()
+{
+    // until all queued configurations have been added to the sums
+
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]{ return pending.empty() && ! busy; });
+}
+
+
+
+void CorrelationAccumulator::clear()
+{
+    // drops queued configurations and the sums
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.clear();
+    }
+    space.notify_all();
+    wait();
+    std::lock_guard<std::mutex> lock(mutex);
+    width = height = 0;
+    configurations = dropped = 0;
+    correlation = Sums();
+    structureFunction = Sums();
+    power.clear();
+}
+
+
+
+void CorrelationAccumulator::work()
+{
+    // the analysis thread
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while( true )
+    {
+        queued.wait(lock, [this]{ return quit || ! pending.empty(); });
+        if( quit ) return;
+
+        Lattice lattice = std::move(pending.front());
+        pending.pop_front();
+        busy = true;
+
+        lock.unlock();
+        space.notify_one();
+        accumulate(lattice);
+        lock.lock();
+
+        busy = false;
+        if( pending.empty() ) idle.notify_all();
+    }
+}
+
+
+
+void CorrelationAccumulator::accumulate(const Lattice& lattice)
+{
+    // the FFTs run without the lock, only adding up takes it
+
+    const StructureFactor S(lattice.spins, lattice.width, lattice.height);
+    const Histogram<double> G = S.computeCorrelation();
+    const Histogram<double> Sk = S.computeStructureFunction();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if( lattice.width != width || lattice.height != height )
+    {
+        // a new lattice size starts the averages anew
+        width = lattice.width;
+        height = lattice.height;
+        dropped += configurations;
+        configurations = 0;
+        correlation = Sums();
+        structureFunction = Sums();
+        power.assign((width/2 + 1) * height, 0);
+    }
+
+    accumulate(correlation, G);
+    accumulate(structureFunction, Sk);
+    for( unsigned long ky = 0; ky < height; ++ky )
+    {
+        for( unsigned long kx = 0; kx <= width/2; ++kx )
+        {
+            power[ky*(width/2 + 1) + kx] += S(kx, ky);
+        }
+    }
+    ++configurations;
+}
+
+
+
+void CorrelationAccumulator::accumulate(Sums& sums, const Histogram<double>& histogram)
+{
+    // the bins only depend on the lattice size, so they are the same for every configuration
+
+    if( sums.position.empty() )
+    {
+        for( const auto& B : histogram )
+        {
+            if( B.entries > 0 ) sums.position.push_back(B.position());
+        }
+        sums.sum.assign(sums.position.size(), 0);
+        sums.squares.assign(sums.position.size(), 0);
+    }
+
+    std::size_t i = 0;
+    for( const auto& B : histogram )
+    {
+        if( B.entries == 0 ) continue;
+        sums.sum[i] += B.counter;
+        sums.squares[i] += B.counter * B.counter;
+        ++i;
+    }
+}
+
+
+
+CorrelationAccumulator::Profile CorrelationAccumulator::profile(const Sums& sums) const
+{
+    Profile P;
+    P.position = sums.position;
+    const double n = configurations;
+    for( std::size_t i = 0; i < sums.sum.size(); ++i )
+    {
+        const double mean = sums.sum[i] / n;
+        const double variance = std::max(0.0, sums.squares[i] / n - mean*mean);
+        P.mean.push_back(mean);
+        P.error.push_back( n > 1 ? std::sqrt(variance / (n - 1)) : 0 );
+    }
+    return P;
+}
+
+
+
+unsigned long CorrelationAccumulator::getConfigurations() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return configurations;
+}
+
+
+
+unsigned long CorrelationAccumulator::getDropped() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+
+
+CorrelationAccumulator::Profile CorrelationAccumulator::getCorrelation() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return profile(correlation);
+}
+
+
+
+CorrelationAccumulator::Profile CorrelationAccumulator::getStructureFunction() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return profile(structureFunction);
+}
+
+
+
+void CorrelationAccumulator::print_structureFactor(std::ostream& STREAM) const
+{
+    // the averaged half plane "kx ky S" in the layout of StructureFactor::print()
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for( unsigned long kx = 0; kx <= width/2; ++kx )
+    {
+        for( unsigned long i = 0; i < height; ++i )
+        {
+            const long ky = static_cast<long>(i) - static_cast<long>(height/2);
+            STREAM << std::setw(8) << kx
+                   << std::setw(8) << ky
+                   << std::setw(20) << std::setprecision(6) << power[((ky + height) % height)*(width/2 + 1) + kx] / configurations
+                   << '\n';
+        }
+        STREAM << '\n';
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "structure_factor.hpp"
+#include "histogram.hpp"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+
+
+// Ensemble average of G(r), S(k) and S(kx, ky) over configurations taken during a production run.
+// add() only queues a copy of the lattice, an analysis thread of its own computes the structure factor of
+// every copy and sums up the bins, so the simulation does not wait for the FFTs. If the analysis falls behind
+// by more than a few configurations, add() waits for it: every configuration handed over is averaged, so the
+// result only depends on the seed. Configurations are only dropped when the lattice size changes, which starts
+// the averages anew.
+// The errors are standard errors of the mean over the configurations, which assumes that they are independent:
+// the configurations should be further apart than the autocorrelation time.
+class CorrelationAccumulator
+{
+public:
+    // bins of a radial average: position, mean and standard error over the configurations
+    struct Profile
+    {
+        std::vector<double> position {};
+        std::vector<double> mean {};
+        std::vector<double> error {};
+    };
+
+    CorrelationAccumulator();
+    CorrelationAccumulator(const CorrelationAccumulator&) = delete;
+    void operator=(const CorrelationAccumulator&) = delete;
+    ~CorrelationAccumulator();
+
+    void add(std::vector<double>, const unsigned long, const unsigned long);
+    void wait();
+    void clear();
+
+    // after wait()
+    unsigned long getConfigurations() const;
+    unsigned long getDropped() const;
+    Profile getCorrelation() const;
+    Profile getStructureFunction() const;
+    void print_structureFactor(std::ostream&) const;
+
+private:
+    struct Lattice
+    {
+        std::vector<double> spins {};
+        unsigned long       width {0};
+        unsigned long       height {0};
+    };
+
+    struct Sums
+    {
+        std::vector<double> position {};
+        std::vector<double> sum {};
+        std::vector<double> squares {};
+    };
+
+    static constexpr std::size_t maxPending = 4;
+
+    void work();
+    void accumulate(const Lattice&);
+    static void accumulate(Sums&, const Histogram<double>&);
+    Profile profile(const Sums&) const;
+
+    mutable std::mutex       mutex {};
+    std::condition_variable  queued {};
+    std::condition_variable  space {};             // the queue has room again
+    std::condition_variable  idle {};
+    std::deque<Lattice>      pending {};
+    bool                     busy {false};
+    bool                     quit {false};
+
+    // the sums, guarded by mutex as well
+    unsigned long            width {0};
+    unsigned long            height {0};
+    unsigned long            configurations {0};
+    unsigned long            dropped {0};
+    Sums                     correlation {};
+    Sums                     structureFunction {};
+    std::vector<double>      power {};             // sum of S(kx, ky) over the stored half plane
+
+    std::thread              thread {};
+};
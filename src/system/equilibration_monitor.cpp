@@ -0,0 +1,77 @@
+#include "equilibration_monitor.hpp"
+#include <algorithm>
+#include <cmath>
+
+
+
+namespace
+{
+    bool agree(const double sum3, const double squares3, const double sum4, const double squares4, const double n, const double tolerance)
+    {
+        // means of two quarters of n samples each are equal within tolerance standard errors
+        const double mean3 = sum3 / n;
+        const double mean4 = sum4 / n;
+        const double variance3 = std::max(0.0, squares3 / n - mean3*mean3);
+        const double variance4 = std::max(0.0, squares4 / n - mean4*mean4);
+        const double error = std::sqrt( (variance3 + variance4) / n );
+        // rounding of the sums, for constant observables
+        const double rounding = 1e-12 * (std::abs(mean3) + std::abs(mean4));
+        return std::abs(mean3 - mean4) <= tolerance * error + rounding;
+    }
+}
+
+
+
+EquilibrationMonitor::EquilibrationMonitor(const std::size_t _minSamples, const double _tolerance)
+  : minSamples(std::max<std::size_t>(_minSamples, 8)),
+    tolerance(_tolerance)
+{
+    clear();
+}
+
+
+
+void EquilibrationMonitor::clear()
+{
+    sums.assign(1, Sums());
+    nextCheck = minSamples;
+    passed = 0;
+}
+
+
+
+void EquilibrationMonitor::add(const double energy, const double magnetisation)
+{
+    // one sample, the stationarity checks are due after every eighth of the samples taken so far
+
+    Sums S = sums.back();
+    S.energy += energy;
+    S.energySquared += energy*energy;
+    S.magnetisation += magnetisation;
+    S.magnetisationSquared += magnetisation*magnetisation;
+    sums.push_back(S);
+
+    const std::size_t n = getSamples();
+    if( n < nextCheck ) return;
+
+    nextCheck = n + std::max<std::size_t>(1, n / 8);
+    passed = stationary() ? passed + 1 : 0;
+}
+
+
+
+bool EquilibrationMonitor::stationary() const
+{
+    // the third and fourth quarter of the samples taken so far
+
+    const std::size_t n = getSamples();
+    const std::size_t quarter = n / 4;
+    const Sums& A = sums[n - 2*quarter];
+    const Sums& B = sums[n - quarter];
+    const Sums& C = sums[n];
+
+    return agree(B.energy - A.energy, B.energySquared - A.energySquared,
+                 C.energy - B.energy, C.energySquared - B.energySquared, quarter, tolerance)
+        && agree(B.magnetisation - A.magnetisation, B.magnetisationSquared - A.magnetisationSquared,
+                 C.magnetisation - B.magnetisation, C.magnetisationSquared - B.magnetisationSquared, quarter, tolerance);
+}
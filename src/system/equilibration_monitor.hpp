@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+
+// Decides when an equilibration run has become stationary, from samples of energy and magnetisation
+// taken during the run. The first half of the samples is discarded as transient, the means of the
+// third and fourth quarter have to agree within `tolerance` standard errors for both observables.
+// The standard errors neglect autocorrelations, which makes the test stricter for slow observables.
+// A single check may pass by chance while the observables still drift, so the checks are spaced by
+// an eighth of the samples taken so far and two consecutive ones have to pass.
+class EquilibrationMonitor
+{
+public:
+    explicit EquilibrationMonitor(const std::size_t _minSamples = 32, const double _tolerance = 2);
+
+    void clear();
+    void add(const double, const double);
+    bool converged() const { return passed >= 2; }
+    std::size_t getSamples() const { return sums.size() - 1; }
+
+private:
+    struct Sums
+    {
+        double energy {0};
+        double energySquared {0};
+        double magnetisation {0};
+        double magnetisationSquared {0};
+    };
+
+    bool stationary() const;
+
+    std::size_t minSamples;
+    double      tolerance;
+
+    std::vector<Sums> sums {};          // sums over the first n samples at index n
+    std::size_t nextCheck {0};
+    unsigned int passed {0};            // consecutive checks that have passed
+};
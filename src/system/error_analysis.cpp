@@ -0,0 +1,93 @@
+#include "error_analysis.hpp"
+#include <algorithm>
+
+
+
+void BlockingTree::add(const double x)
+{
+    // the sample enters level 0, every second block of a level is averaged with its partner into the next
+
+    double value = x;
+    for( std::size_t k = 0; ; ++k )
+    {
+        if( k == levels.size() ) levels.emplace_back();
+        Level& L = levels[k];
+
+        ++L.blocks;
+        const double delta = value - L.mean;
+        L.mean += delta / L.blocks;
+        L.squares += delta * (value - L.mean);
+
+        if( ! L.hasWaiting )
+        {
+            L.waiting = value;
+            L.hasWaiting = true;
+            return;
+        }
+        value = (L.waiting + value) / 2;
+        L.hasWaiting = false;
+    }
+}
+
+
+
+const BlockingTree::Level* BlockingTree::plateau() const
+{
+    // the first level the next two agree with, else the highest level with enough blocks, level 0 for short runs
+
+    if( levels.empty() ) return nullptr;
+    for( std::size_t k = 0; k + 2 < levels.size() && levels[k+2].blocks >= minBlocks; ++k )
+    {
+        const double error = std::sqrt(levels[k].varianceOfMean());
+        const double bound = error * (1 + 1 / std::sqrt(2 * (levels[k].blocks - 1.0)));
+        if( std::sqrt(levels[k+1].varianceOfMean()) <= bound && std::sqrt(levels[k+2].varianceOfMean()) <= bound )
+        {
+            return &levels[k];
+        }
+    }
+
+    const Level* P = &levels.front();
+    for( const auto& L : levels )
+    {
+        if( L.blocks >= minBlocks ) P = &L;
+    }
+    return P;
+}
+
+
+
+double BlockingTree::error() const
+{
+    const Level* P = plateau();
+    return P ? std::sqrt(P->varianceOfMean()) : 0;
+}
+
+
+
+double BlockingTree::tau() const
+{
+    const Level* P = plateau();
+    if( P == nullptr || levels.front().varianceOfMean() <= 0 ) return 0.5;
+    return 0.5 * std::max(1.0, P->varianceOfMean() / levels.front().varianceOfMean());
+}
+
+
+
+void JackknifeBins::add(const double energy, const double magnetisation)
+{
+    current.add(energy, magnetisation);
+    if( current.getSamples() < binSize ) return;
+
+    bins.push_back(current);
+    current.clear();
+    if( bins.size() == maxBins )
+    {
+        for( std::size_t i = 0; i < maxBins/2; ++i )
+        {
+            bins[i] = bins[2*i];
+            bins[i].merge(bins[2*i + 1]);
+        }
+        bins.resize(maxBins/2);
+        binSize *= 2;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "moments.hpp"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+
+
+// Blocking analysis of Flyvbjerg and Petersen for the mean of one correlated observable, run alongside the
+// sampling: level k averages blocks of 2^k consecutive samples, and only the statistics of every level and at
+// most one sample waiting for its partner are kept, so memory grows with log(n).
+// The error of the mean estimated from blocks grows with the block size until the blocks are longer than
+// the correlations. The plateau is the first level whose error the next two levels match within its own
+// uncertainty err / sqrt(2 (blocks - 1)), using levels with at least minBlocks blocks. Without a plateau the
+// run is too short and the highest such level gives a lower bound. The ratio of the variance of the mean at
+// the plateau to the naive one of level 0 is 2 tau_int.
+class BlockingTree
+{
+public:
+    static constexpr unsigned long minBlocks = 32;
+
+    void add(const double);
+    void clear() { levels.clear(); }
+
+    double error() const;       // standard error of the mean
+    double tau() const;         // integrated autocorrelation time in samples, 0.5 for uncorrelated ones
+
+private:
+    struct Level
+    {
+        unsigned long blocks {0};
+        double        mean {0};
+        double        squares {0};      // sum of squared deviations from the mean, Welford
+        double        waiting {0};      // block without its partner
+        bool          hasWaiting {false};
+
+        double varianceOfMean() const { return blocks > 1 ? squares / (blocks * (blocks - 1.0)) : 0; }
+    };
+
+    const Level* plateau() const;
+
+    std::vector<Level> levels {};
+};
+
+
+
+// Jackknife errors of quantities of the moments, e.g. the fluctuations chi and Cv, which are no plain
+// means of the samples. The samples are collected in at most maxBins bins of equal size, every time they
+// are full neighbouring bins are merged and the bin size doubles. A leave-one-out estimate is taken
+// without each complete bin, the partly filled bin is left out.
+class JackknifeBins
+{
+public:
+    static constexpr std::size_t maxBins = 64;
+
+    void add(const double, const double);
+    void clear() { *this = JackknifeBins(); }
+
+    const std::vector<Moments>& getBins() const { return bins; }
+
+private:
+    std::vector<Moments> bins {};
+    Moments              current {};
+    unsigned long        binSize {1};
+};
+
+
+
+// jackknife error of f(Moments) over independent or binned groups of samples
+template<typename F>
+double jackknife(const std::vector<Moments>& groups, F&& f)
+{
+    const std::size_t n = groups.size();
+    if( n < 2 ) return 0;
+
+    std::vector<double> estimates(n);
+    for( std::size_t j = 0; j < n; ++j )
+    {
+        Moments rest;
+        for( std::size_t i = 0; i < n; ++i )
+        {
+            if( i != j ) rest.merge(groups[i]);
+        }
+        estimates[j] = f(rest);
+    }
+
+    double mean = 0;
+    for( const double e : estimates ) mean += e / n;
+    double squares = 0;
+    for( const double e : estimates ) squares += (e - mean) * (e - mean);
+    return std::sqrt( (n - 1.0) / n * squares );
+}
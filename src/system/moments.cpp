@@ -0,0 +1,55 @@
+#include "moments.hpp"
+#include <cmath>
+
+
+
+void Moments::Welford::add(const double x, const unsigned long n)
+{
+    // n counts x already
+    const double delta = x - mean;
+    mean += delta / n;
+    squares += delta * (x - mean);
+}
+
+
+
+void Moments::Welford::merge(const Welford& other, const unsigned long n, const unsigned long m)
+{
+    // n samples of this and m of other
+    const double total = n + m;
+    const double delta = other.mean - mean;
+    mean += delta * m / total;
+    squares += other.squares + delta * delta * n / total * m;
+}
+
+
+
+void Moments::add(const double energy, const double magnetisation)
+{
+    ++samples;
+    E.add(energy, samples);
+    M.add(magnetisation, samples);
+
+    const double squared = magnetisation * magnetisation;
+    absM += (std::abs(magnetisation) - absM) / samples;
+    M4 += (squared * squared - M4) / samples;
+}
+
+
+
+void Moments::merge(const Moments& other)
+{
+    if( other.samples == 0 ) return;
+    if( samples == 0 )
+    {
+        *this = other;
+        return;
+    }
+
+    const double total = samples + other.samples;
+    E.merge(other.E, samples, other.samples);
+    M.merge(other.M, samples, other.samples);
+    absM += (other.absM - absM) * other.samples / total;
+    M4 += (other.M4 - M4) * other.samples / total;
+    samples += other.samples;
+}
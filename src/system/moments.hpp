@@ -0,0 +1,43 @@
+#pragma once
+
+
+// Moments of the recorded energies and magnetisations: <E>, <E^2>, <M>, <M^2>, <|M|> and <M^4>, updated in
+// O(1) per sample without keeping the samples. E and M are kept as mean and sum of squared deviations
+// (Welford), so the variances do not cancel out for large lattices where <E^2> and <E>^2 are both huge.
+// <|M|> and <M^4> are running means. merge() adds the samples of another accumulator, e.g. of another
+// thread or replica (pairwise update of Chan, Golub and LeVeque).
+class Moments
+{
+public:
+    void add(const double, const double);
+    void merge(const Moments&);
+    void clear() { *this = Moments(); }
+
+    unsigned long getSamples() const { return samples; }
+
+    double energy() const                   { return E.mean; }
+    double energySquared() const            { return energyVariance() + E.mean*E.mean; }
+    double energyVariance() const           { return E.variance(samples); }
+    double magnetisation() const            { return M.mean; }
+    double magnetisationSquared() const     { return magnetisationVariance() + M.mean*M.mean; }
+    double magnetisationVariance() const    { return M.variance(samples); }
+    double absMagnetisation() const         { return absM; }
+    double magnetisationFourth() const      { return M4; }
+
+private:
+    struct Welford
+    {
+        double mean {0};
+        double squares {0};         // sum of squared deviations from the mean
+
+        void add(const double, const unsigned long);
+        void merge(const Welford&, const unsigned long, const unsigned long);
+        double variance(const unsigned long n) const { return n > 0 ? squares / n : 0; }
+    };
+
+    unsigned long samples {0};
+    Welford E {};
+    Welford M {};
+    double  absM {0};
+    double  M4 {0};
+};
@@ -4,8 +4,17 @@
 
 void MonteCarloHost::run(const unsigned long& steps, const bool EQUILMODE)
 {
-    qDebug() << __PRETTY_FUNCTION__;        // diese beiden Zeilen bitte 
-    Q_CHECK_PTR(parameters);                // einfach stehen lassen und ignorieren
+    qDebug() << __PRETTY_FUNCTION__;        // diese Zeile bitte einfach stehen lassen und ignorieren
+
+    // take over parameters published since the last call; a new size only takes effect with the next
+    // setup(), until then the parameters keep the size of the lattice
+    if( auto snapshot = std::atomic_exchange(&published, std::shared_ptr<const SimulationParameters>()) )
+    {
+        SimulationParameters P = *snapshot;
+        P.width  = spinsystem.getWidth();
+        P.height = spinsystem.getHeight();
+        setParameters(P);
+    }
 
 
      /* Aufgabe 1.7:
@@ -17,53 +26,249 @@ void MonteCarloHost::run(const unsigned long& steps, const bool EQUILMODE)
      *           Schritte nach dem Metropoliskriterium.
      *           Bei EQUILMODE = false: Speichern der aktuellen Werte von 
      *           Hamiltonian und Magnetisierung nach Durchführung der Schritte 
-     *           durch anhängen an die Membervariablen "energies" und "magnetisations".
+     *           durch Aufnahme in die Membervariable "moments" (und optional
+     *           in die Zeitreihe der .data Datei), siehe record().
      */
 
-    double energy_old;
-    double energy_new;
-    
-    for(unsigned int t=0; t<steps; ++t)   
+    // acceptance probabilities are only recomputed if J, B or T have changed
+    if( acceptanceTable.update(spinsystem.getInteraction(), spinsystem.getMagnetic(), getTemperature()) )
     {
-        // flip spin:
-        energy_old = spinsystem.getHamiltonian();
-        spinsystem.flip();
-        energy_new = spinsystem.getHamiltonian();
-    
-        // check metropolis criterion:
-        if( ! acceptance(energy_old, energy_new, getTemperature()) )
+        // cluster sizes depend on the parameters
+        clusterSizes = 0;
+        clusterUpdates = 0;
+    }
+
+    const ALGORITHM algorithm = parameters.algorithm;
+
+    // checkerboard sweeps run on the bit-packed lattice where it is supported, all other updates need the dense one
+    spinsystem.setPacked( algorithm == ALGORITHM::Checkerboard && ! spinsystem.getSpinExchange() );
+
+    if( (algorithm == ALGORITHM::Checkerboard || algorithm == ALGORITHM::SwendsenWang) && ! spinsystem.getSpinExchange() )
+    {
+        // a sweep offers a flip to every spin, so it accounts for as many steps as there are spins,
+        // left over steps are carried over to the next call
+        const long spinsPerSweep = spinsystem.getSize();
+        stepCredit += steps;
+        while( stepCredit >= spinsPerSweep )
         {
-            spinsystem.flip_back(); 
-            isingDEBUG("mc: " << "move rejected, new H would have been: " << energy_new)
+            if( algorithm == ALGORITHM::Checkerboard ) checkerboardSweep();
+            else                                       swendsenWangSweep();
+            stepCredit -= spinsPerSweep;
         }
-        else
+    }
+    else if( algorithm == ALGORITHM::Wolff && ! spinsystem.getSpinExchange() )
+    {
+        wolffUpdates(steps);
+    }
+    else if( algorithm == ALGORITHM::NFoldWay && ! spinsystem.getSpinExchange() )
+    {
+        // the steps are the physical time in single-spin Metropolis steps, the sample recorded below
+        // is the state at the end of that time
+        spinsystem.nFoldWay(steps, [&](const int dBonds, const int dSpins){ return acceptanceTable.probability(dBonds, dSpins); }, engine);
+    }
+    else
+    {
+        for(unsigned int t=0; t<steps; ++t)   
         {
-            isingDEBUG("mc: " << "move accepted, new H: " << energy_new)
-            isingDEBUG(spinsystem.getStringOfSystem())
+            // propose a move, the lattice is only written if it is accepted:
+            const Move move = spinsystem.propose();
+    
+            // check metropolis criterion:
+            if( acceptance(move.change, move.proposalRatio) )
+            {
+                spinsystem.commit(move);
+                isingDEBUG("mc: " << "move accepted, new H: " << spinsystem.getHamiltonian())
+                isingDEBUG(spinsystem.getStringOfSystem())
+            }
+            else
+            {
+                isingDEBUG("mc: " << "move rejected (dBonds = " << move.change.bonds << ", dSpins = " << move.change.spins << ")")
+            }
         }
     }
     
+    // debug builds check the running spin sum against a full count, here on the simulation thread where
+    // the lattice is not changed meanwhile
+    assert( spinsystem.getSpinSum() == spinsystem.countSpins() );
+
     if( !EQUILMODE )
     {
-        energies.push_back(spinsystem.getHamiltonian());
-        magnetisations.push_back(spinsystem.getMagnetisation());
+        record();
     }
 
 }
 
 
 
-bool MonteCarloHost::acceptance(const double Eold, const double Enew, const double temperature)
+void MonteCarloHost::record()
 {
+    // one sample of the production run: added to the moments, appended to the time series and every
+    // correlationFreq-th one goes to the averaged G(r) and S(k), analysed on a thread of its own
+
+    const double energy = spinsystem.getHamiltonian();
+    const double magnetisation = spinsystem.getMagnetisation();
+    moments.add(energy, magnetisation);
+    energyBlocks.add(energy);
+    magnetisationBlocks.add(magnetisation);
+    jackknifeBins.add(energy, magnetisation);
+
+    if( parameters.timeSeries )
+    {
+        if( ! timeSeries )
+        {
+            std::string filekeystring = parameters.fileKey;
+            std::string filekey = filekeystring.substr( 0, filekeystring.find_first_of(" ") );
+            filekey.append(".data");
+
+            timeSeries = std::make_unique<std::ofstream>(filekey);
+            *timeSeries << std::setw(14) << "# step"
+                        << std::setw(8) << "J"
+                        << std::setw(8) << "T"
+                        << std::setw(8) << "B"
+                        << std::setw(14) << "H"
+                        << std::setw(14) << "M"
+                        << '\n';
+        }
+        *timeSeries << std::setw(14) << std::fixed << std::setprecision(0) << moments.getSamples() * parameters.printFreq
+                    << std::setw(8) << std::fixed << std::setprecision(2) << parameters.interaction
+                    << std::setw(8) << std::fixed << std::setprecision(2) << getTemperature()
+                    << std::setw(8) << std::fixed << std::setprecision(2) << parameters.magnetic
+                    << std::setw(14) << std::fixed << std::setprecision(2) << energy
+                    << std::setw(14) << std::fixed << std::setprecision(6) << magnetisation
+                    << '\n';
+    }
+
+    if( parameters.correlationFreq > 0 && moments.getSamples() % parameters.correlationFreq == 0 )
+    {
+        if( ! correlationAccumulator )
+        {
+            correlationAccumulator = std::make_unique<CorrelationAccumulator>();
+        }
+        correlationAccumulator->add(spinsystem.getSpinTypes(), spinsystem.getWidth(), spinsystem.getHeight());
+    }
+}
+
+
+
+bool MonteCarloHost::acceptance(const EnergyChange& change, const double proposalRatio)
+{
+    // Metropolis criterion from the precomputed table, downhill moves draw no random number;
+    // spin exchanges propose from the interface list and need the Hastings correction proposalRatio
     
     #ifndef NDEBUG
-        double random = enhance::randomDouble(0.0, 1.0);
-        double condition = std::exp(-(Enew-Eold)/temperature);
-        isingDEBUG("mc: " << "random = " << random << ", exp(-(energy_new-energy_old)/temperature) = " << condition)
-        return random < condition ? true : false;
+        if( proposalRatio == 1 && acceptanceTable.alwaysAccepted(change.bonds, change.spins) )
+        {
+            isingDEBUG("mc: " << "downhill move (dBonds = " << change.bonds << ", dSpins = " << change.spins << ")")
+            return true;
+        }
+        isingDEBUG("mc: " << "exp(-(energy_new-energy_old)/temperature) * 2^64 = " << acceptanceTable.threshold(change.bonds, change.spins) << ", proposal ratio = " << proposalRatio)
     #endif
 
-    return enhance::randomDouble(0.0, 1.0) < std::exp(-(Enew-Eold)/temperature) ? true : false;
+    return acceptanceTable.accept(change.bonds, change.spins, proposalRatio, engine);
+}
+
+
+
+void MonteCarloHost::checkerboardSweep()
+{
+    // one parallel sweep over both sublattices, each row block draws from its own engine
+
+    setupThreads(threads > 0 ? threads : parameters.threads);
+    Q_CHECK_PTR(threadPool);
+
+    if( spinsystem.isPacked() )
+    {
+        spinsystem.checkerboardSweep(*threadPool, acceptanceTable, vectorEngines);
+    }
+    else
+    {
+        spinsystem.checkerboardSweep(*threadPool, [&](const EnergyChange& change, const std::size_t block)
+        {
+            return acceptanceTable.accept(change.bonds, change.spins, engines[block]);
+        });
+    }
+    isingDEBUG("mc: " << "checkerboard sweep done, new H: " << spinsystem.getHamiltonian())
+}
+
+
+
+void MonteCarloHost::swendsenWangSweep()
+{
+    // one parallel Swendsen-Wang update, each row block draws from its own engine
+
+    setupThreads(threads > 0 ? threads : parameters.threads);
+    Q_CHECK_PTR(threadPool);
+
+    spinsystem.swendsenWangSweep(*threadPool, acceptanceTable.clusterBondThreshold(), acceptanceTable.ghostBondThreshold(), engines);
+    isingDEBUG("mc: " << "swendsen-wang sweep done, new H: " << spinsystem.getHamiltonian())
+}
+
+
+
+void MonteCarloHost::wolffUpdates(const unsigned long steps)
+{
+    // Wolff cluster updates worth the given number of steps. A cluster accounts for as many steps as
+    // spins it visits on average and the number of clusters is fixed before they are grown: stopping as
+    // soon as the visited spins add up would favour ending on a large cluster and bias the samples
+    // towards ordered states. The mean cluster size is collected since the last change of the
+    // parameters; while it is still uncertain, a round grows at most as many clusters as have been
+    // collected so far. Left over steps are carried over to the next call, as is the debt if the first
+    // cluster, which is charged with its own size, has used up more than the credit.
+
+    stepCredit += steps;
+    while( stepCredit > 0 )
+    {
+        if( clusterUpdates == 0 )
+        {
+            const unsigned long size = spinsystem.wolffUpdate(acceptanceTable.clusterBondThreshold(), acceptanceTable.ghostBondThreshold(), engine);
+            clusterSizes += size;
+            ++clusterUpdates;
+            stepCredit -= static_cast<long>(size);
+            continue;
+        }
+
+        const double meanClusterSize = static_cast<double>(clusterSizes) / clusterUpdates;
+        const long   updates = std::min<long>( std::lround(stepCredit / meanClusterSize), clusterUpdates );
+        if( updates <= 0 ) break;
+
+        for( long i = 0; i < updates; ++i )
+        {
+            clusterSizes += spinsystem.wolffUpdate(acceptanceTable.clusterBondThreshold(), acceptanceTable.ghostBondThreshold(), engine);
+        }
+        clusterUpdates += updates;
+        stepCredit -= std::lround(updates * meanClusterSize);
+    }
+    isingDEBUG("mc: " << "wolff updates done, mean cluster size " << static_cast<double>(clusterSizes) / clusterUpdates << ", new H: " << spinsystem.getHamiltonian())
+}
+
+
+
+void MonteCarloHost::setupThreads(const unsigned int threads)
+{
+    // (re)create the thread pool if the number of threads has changed,
+    // the engines of the row blocks are streams split off the engine of this host
+
+    if( threadPool && threadPool->size() == threads ) return;
+
+    threadPool = std::make_unique<enhance::ThreadPool>(std::max(1u, threads));
+    splitEngines();
+    isingLOG("mc: " << "using " << threadPool->size() << " threads for parallel sweeps, " << PackedLattice::kernelName() << " kernel for packed sweeps")
+}
+
+
+
+void MonteCarloHost::splitEngines()
+{
+    // one engine per thread of the pool, split off the engine of this host
+
+    engines.clear();
+    vectorEngines.clear();
+    if( ! threadPool ) return;
+    for( unsigned int i = 0; i < threadPool->size(); ++i )
+    {
+        engines.emplace_back( engine.split() );
+        vectorEngines.emplace_back( engine );
+    }
 }
 
 
@@ -76,8 +281,35 @@ bool MonteCarloHost::acceptance(const double Eold, const double Enew, const doub
 
 double MonteCarloHost::getTemperature() const 
 { 
-    Q_CHECK_PTR(parameters); 
-    return parameters->getTemperature(); 
+    return ownTemperature ? temperature : parameters.temperature; 
+}
+
+
+void MonteCarloHost::setTemperature(const double T)
+{
+    // run at T instead of the temperature of the parameters
+    temperature = T;
+    ownTemperature = true;
+}
+
+
+void MonteCarloHost::setThreads(const unsigned int n)
+{
+    // threads of the parallel sweeps, 0 takes them from the parameters
+    threads = n;
+}
+
+
+void MonteCarloHost::exchangeTemperature(MonteCarloHost& other)
+{
+    // replica exchange: swap temperatures together with the records taken at them, the lattices stay
+    assert( ownTemperature && other.ownTemperature );
+    std::swap(temperature, other.temperature);
+    std::swap(moments, other.moments);
+    std::swap(energyBlocks, other.energyBlocks);
+    std::swap(magnetisationBlocks, other.magnetisationBlocks);
+    std::swap(jackknifeBins, other.jackknifeBins);
+    std::swap(timeSeries, other.timeSeries);
 }
 
 
@@ -101,24 +333,37 @@ const Spinsystem& MonteCarloHost::getSpinsystem() const
 }
 
 
-void MonteCarloHost::setParameters(BaseParametersWidget* prms)
+void MonteCarloHost::setParameters(const SimulationParameters& prms)
 {
+    // not while run() is executing, use publish() then
     qDebug() << __PRETTY_FUNCTION__;
 
-    Q_CHECK_PTR(prms);
     parameters = prms;
-    Q_CHECK_PTR(parameters);
+    spinsystem.setParameters(parameters);
 }
 
 
-void MonteCarloHost::setup()
+void MonteCarloHost::publish(std::shared_ptr<const SimulationParameters> snapshot)
 {
+    // hand over new parameters from any thread, run() takes them over before its next step;
+    // a snapshot not yet taken over is replaced
+    std::atomic_store(&published, std::move(snapshot));
+}
+
+
+void MonteCarloHost::setup(enhance::Xoshiro256& source)
+{
+    // new system, all random numbers of this host are split off source
     qDebug() << __PRETTY_FUNCTION__;
     
-    Q_CHECK_PTR(parameters);
-    
     spinsystem.setParameters(parameters);
-    spinsystem.setup();
+    spinsystem.setup(source);
+    parameters.width  = spinsystem.getWidth();      // the spin system may have rounded the size up
+    parameters.height = spinsystem.getHeight();
+    engine = source.split();
+    splitEngines();     // the engines of the row blocks must not carry on the streams of the previous system
+    clusterSizes = 0;
+    clusterUpdates = 0;
     
     clearRecords();
 }
@@ -127,12 +372,10 @@ void MonteCarloHost::setup()
 void MonteCarloHost::resetSpins()
 {
     qDebug() << __PRETTY_FUNCTION__;
-
-    Q_CHECK_PTR(parameters);
     
-    if( parameters->getWavelengthPattern() )
+    if( parameters.wavelengthPattern )
     {
-        spinsystem.resetSpinsCosinus(parameters->getWavelength());
+        spinsystem.resetSpinsCosinus(parameters.wavelength);
     }
     else
     {
@@ -145,8 +388,16 @@ void MonteCarloHost::clearRecords()
 {
     qDebug() << __PRETTY_FUNCTION__;
 
-    energies.clear();
-    magnetisations.clear();
+    moments.clear();
+    energyBlocks.clear();
+    magnetisationBlocks.clear();
+    jackknifeBins.clear();
+    timeSeries.reset();
+    stepCredit = 0;
+    if( correlationAccumulator )
+    {
+        correlationAccumulator->clear();
+    }
 
     spinsystem.resetParameters();
     
@@ -155,41 +406,20 @@ void MonteCarloHost::clearRecords()
 
 void MonteCarloHost::print_data() const
 {
-    // save to file:  step  J  T  B  H  M  
+    // the time series (step  J  T  B  H  M) is written to the .data file while it is recorded,
+    // flush what has been recorded so far
 
     qDebug() << __PRETTY_FUNCTION__;
     isingDEBUG("mc: " << "saving data ...")
-    
-    Q_CHECK_PTR(parameters);
-    std::string filekeystring = parameters->getFileKey();
-    std::string filekey = filekeystring.substr( 0, filekeystring.find_first_of(" ") );
-    filekey.append(".data");
 
-    std::ofstream FILE;
-    FILE.open(filekey);
-    
-    // print header line
-    FILE << std::setw(14) << "# step"
-    << std::setw(8) << "J"
-    << std::setw(8) << "T"
-    << std::setw(8) << "B"
-    << std::setw(14) << "H"
-    << std::setw(14) << "M"
-    << '\n';
-    
-    assert(energies.size() == magnetisations.size());
-    for(unsigned int i=0; i<energies.size(); ++i)
+    if( timeSeries )
     {
-        FILE << std::setw(14) << std::fixed << std::setprecision(0)<< (i+1)*parameters->getPrintFreq()
-             << std::setw(8) << std::fixed << std::setprecision(2)<< parameters->getInteraction()
-             << std::setw(8) << std::fixed << std::setprecision(2)<< parameters->getTemperature()
-             << std::setw(8) << std::fixed << std::setprecision(2)<< parameters->getMagnetic()
-             << std::setw(14) << std::fixed << std::setprecision(2) << energies[i]
-             << std::setw(14) << std::fixed << std::setprecision(6) << magnetisations[i];
-        FILE << '\n';
+        timeSeries->flush();
+    }
+    else if( ! parameters.timeSeries )
+    {
+        isingLOG("mc: " << "no time series recorded, .data is not written")
     }
-    
-    FILE.close();
 }
 
 
@@ -200,59 +430,109 @@ void MonteCarloHost::print_averages() const
     qDebug() << __PRETTY_FUNCTION__;
     isingDEBUG("mc: " << "saving averaged data ...")
 
-    Q_CHECK_PTR(parameters);
-    std::string filekeystring = parameters->getFileKey();
+    std::string filekeystring = parameters.fileKey;
     std::string filekey = filekeystring.substr( 0, filekeystring.find_first_of(" ") );
     filekey.append(".averaged_data");
 
     std::ofstream FILE;
     if( ! enhance::fileExists(filekey) )
     {
-        // print header line
         FILE.open(filekey);
-        FILE << std::setw(8) << "J"
-             << std::setw(8) << "T"
-             << std::setw(8) << "B"
-             << std::setw(14) << "<H>"
-             << std::setw(14) << "<M>"
-             << std::setw(18) << "<chi>"
-             << std::setw(18) << "<Cv>"
-             << std::setw(14) << "# of samples"
-             << '\n';
+        print_averagesHeader(FILE);
     }
     else
     {
         FILE.open(filekey, std::ios::app);
     }
-    double averageEnergies = std::accumulate(std::begin(energies), std::end(energies), 0.0) / energies.size();
-    double averageEnergiesSquared = std::accumulate(std::begin(energies), std::end(energies), 0.0, [](auto lhs, auto rhs){ return lhs + rhs*rhs; }) / energies.size();
-    double averageMagnetisations = std::accumulate(std::begin(magnetisations), std::end(magnetisations), 0.0) / magnetisations.size();
-    double averageMagnetisationsSquared = std::accumulate(std::begin(magnetisations), std::end(magnetisations), 0.0, [](auto lhs, auto rhs){ return lhs + rhs*rhs; }) / magnetisations.size();
-    double denominator = std::pow(parameters->getTemperature(),2) * std::pow(parameters->getWidth()*parameters->getHeight(),2);
-    
-    FILE << std::setw(8) << std::fixed << std::setprecision(2) << parameters->getInteraction()
-         << std::setw(8) << std::fixed << std::setprecision(2) << parameters->getTemperature()
-         << std::setw(8) << std::fixed << std::setprecision(2) << parameters->getMagnetic()
-         << std::setw(14) << std::fixed << std::setprecision(2) << averageEnergies
-         << std::setw(14) << std::fixed << std::setprecision(6) << averageMagnetisations
-         << std::setw(18) << std::fixed << std::setprecision(10) << (averageMagnetisationsSquared - averageMagnetisations*averageMagnetisations) / parameters->getTemperature()
-         << std::setw(18) << std::fixed << std::setprecision(10) << (averageEnergiesSquared - averageEnergies*averageEnergies) / denominator
-         << std::setw(14) << energies.size() 
-         << '\n';
+    print_averages(FILE);
     
     FILE.close();
 }
 
 
-void MonteCarloHost::print_correlation(Histogram<double>& correlation) const
+void MonteCarloHost::print_averagesHeader(std::ostream& FILE)
+{
+    // header line of the .averaged_data file
+
+    FILE << std::setw(8) << "J"
+         << std::setw(8) << "T"
+         << std::setw(8) << "B"
+         << std::setw(14) << "<H>"
+         << std::setw(14) << "<M>"
+         << std::setw(18) << "<chi>"
+         << std::setw(18) << "<Cv>"
+         << std::setw(14) << "# of samples"
+         << std::setw(14) << "err<H>"
+         << std::setw(14) << "err<M>"
+         << std::setw(18) << "err<chi>"
+         << std::setw(18) << "err<Cv>"
+         << std::setw(12) << "tau<H>"
+         << std::setw(12) << "tau<M>"
+         << '\n';
+}
+
+
+Averages MonteCarloHost::getAverages() const
+{
+    // per spin of the lattice the samples were taken on, parameters may already hold the size of the next setup()
+    double denominator = std::pow(getTemperature(),2) * std::pow(spinsystem.getSize(),2);
+
+    Averages A;
+    A.energy = moments.energy();
+    A.magnetisation = moments.magnetisation();
+    A.susceptibility = moments.magnetisationVariance() / getTemperature();
+    A.heatCapacity = moments.energyVariance() / denominator;
+    A.samples = moments.getSamples();
+
+    const double T = getTemperature();
+    A.energyError = energyBlocks.error();
+    A.magnetisationError = magnetisationBlocks.error();
+    A.susceptibilityError = jackknife(jackknifeBins.getBins(), [T](const Moments& M){ return M.magnetisationVariance() / T; });
+    A.heatCapacityError = jackknife(jackknifeBins.getBins(), [denominator](const Moments& M){ return M.energyVariance() / denominator; });
+    A.energyTau = energyBlocks.tau();
+    A.magnetisationTau = magnetisationBlocks.tau();
+    return A;
+}
+
+
+void MonteCarloHost::print_averages(std::ostream& FILE) const
+{
+    // one line of the .averaged_data file
+
+    print_averagesLine(FILE, parameters.interaction, getTemperature(), parameters.magnetic, getAverages());
+}
+
+
+void MonteCarloHost::print_averagesLine(std::ostream& FILE, const double J, const double T, const double B, const Averages& A)
+{
+    // line of the .averaged_data file for the averages A at J, T and B, also written by the other hosts
+
+    FILE << std::setw(8) << std::fixed << std::setprecision(2) << J
+         << std::setw(8) << std::fixed << std::setprecision(2) << T
+         << std::setw(8) << std::fixed << std::setprecision(2) << B
+         << std::setw(14) << std::fixed << std::setprecision(2) << A.energy
+         << std::setw(14) << std::fixed << std::setprecision(6) << A.magnetisation
+         << std::setw(18) << std::fixed << std::setprecision(10) << A.susceptibility
+         << std::setw(18) << std::fixed << std::setprecision(10) << A.heatCapacity
+         << std::setw(14) << A.samples 
+         << std::setw(14) << std::fixed << std::setprecision(2) << A.energyError
+         << std::setw(14) << std::fixed << std::setprecision(6) << A.magnetisationError
+         << std::setw(18) << std::fixed << std::setprecision(10) << A.susceptibilityError
+         << std::setw(18) << std::fixed << std::setprecision(10) << A.heatCapacityError
+         << std::setw(12) << std::fixed << std::setprecision(2) << A.energyTau
+         << std::setw(12) << std::fixed << std::setprecision(2) << A.magnetisationTau
+         << '\n';
+}
+
+
+void MonteCarloHost::print_correlation(const Histogram<double>& correlation) const
 {
     // save correlation of current state in file  
 
     qDebug() << __PRETTY_FUNCTION__;
     isingDEBUG("mc: " << "saving correlation function G(r) ...")
 
-    Q_CHECK_PTR(parameters);
-    std::string filekeystring = parameters->getFileKey();
+    std::string filekeystring = parameters.fileKey;
     std::string filekey = filekeystring.substr( 0, filekeystring.find_first_of(" ") );
     filekey.append(".correlation");
 
@@ -263,21 +543,86 @@ void MonteCarloHost::print_correlation(Histogram<double>& correlation) const
 }
 
 
-void MonteCarloHost::print_structureFunction(Histogram<double>& structureFunction) const
+void MonteCarloHost::print_structureFunction(const Histogram<double>& structureFunction) const
 {
     // save structure Function of current state in file
 
     qDebug() << __PRETTY_FUNCTION__;
     isingDEBUG("mc: " << "saving structure function S(k) ...")
 
-    Q_CHECK_PTR(parameters);
-    std::string filekeystring = parameters->getFileKey();
+    std::string filekeystring = parameters.fileKey;
     std::string filekey = filekeystring.substr( 0, filekeystring.find_first_of(" ") );
     filekey.append(".structureFunction");
 
     std::ofstream FILE(filekey);
-    FILE << "# structure function S(k) = FT( G(r) )\n";
+    FILE << "# structure function S(k) = |s(k)|^2 / N, averaged over |k| in units of 2PI/width\n";
     FILE << structureFunction.formatted_string();
     FILE.close();
 }
 
+
+void MonteCarloHost::print_structureFactor(const StructureFactor& structureFactor) const
+{
+    // save the full S(kx, ky) of the current state in file
+
+    qDebug() << __PRETTY_FUNCTION__;
+    isingDEBUG("mc: " << "saving structure factor S(kx, ky) ...")
+
+    std::string filekeystring = parameters.fileKey;
+    std::string filekey = filekeystring.substr( 0, filekeystring.find_first_of(" ") );
+    filekey.append(".structureFactor");
+
+    std::ofstream FILE(filekey);
+    FILE << "# structure factor S(kx, ky) = |s(k)|^2 / N, kx in units of 2PI/width, ky in units of 2PI/height\n";
+    FILE << "#     kx      ky                   S\n";
+    structureFactor.print(FILE);
+    FILE.close();
+}
+
+
+void MonteCarloHost::print_correlationAverages() const
+{
+    // save G(r), S(k) and S(kx, ky) averaged over the configurations of the production run, with standard errors;
+    // waits for the analysis of the configurations still queued
+
+    qDebug() << __PRETTY_FUNCTION__;
+
+    if( ! correlationAccumulator )
+    {
+        isingLOG("mc: " << "no configurations for averaged correlations, correlation frequency is " << parameters.correlationFreq)
+        return;
+    }
+    correlationAccumulator->wait();
+    const unsigned long configurations = correlationAccumulator->getConfigurations();
+    if( configurations == 0 ) return;
+    const unsigned long dropped = correlationAccumulator->getDropped();
+    isingDEBUG("mc: " << "saving correlation function and structure factor averaged over " << configurations << " configurations ...")
+    if( dropped > 0 )
+    {
+        isingLOG("mc: " << dropped << " configurations of an earlier lattice size dropped")
+    }
+
+    std::string filekeystring = parameters.fileKey;
+    std::string filekey = filekeystring.substr( 0, filekeystring.find_first_of(" ") );
+
+    auto print = [&](const std::string& extension, const std::string& title, const CorrelationAccumulator::Profile& P)
+    {
+        std::ofstream FILE(filekey + extension);
+        FILE << "# " << title << ", averaged over " << configurations << " configurations, " << dropped << " dropped\n";
+        FILE << "# position, mean, standard error\n";
+        for( std::size_t i = 0; i < P.position.size(); ++i )
+        {
+            FILE << std::setw(10) << std::setprecision(4) << P.position[i]
+                 << std::setw(20) << std::setprecision(4) << P.mean[i]
+                 << std::setw(20) << std::setprecision(4) << P.error[i] << '\n';
+        }
+    };
+    print(".correlation", "correlation G(r) = <S(0) S(r)> - <S>^2", correlationAccumulator->getCorrelation());
+    print(".structureFunction", "structure function S(k) = |s(k)|^2 / N, radial average in units of 2PI/width", correlationAccumulator->getStructureFunction());
+
+    std::ofstream FILE(filekey + ".structureFactor");
+    FILE << "# structure factor S(kx, ky) = |s(k)|^2 / N, averaged over " << configurations << " configurations, " << dropped << " dropped\n";
+    FILE << "#     kx      ky                   S\n";
+    correlationAccumulator->print_structureFactor(FILE);
+}
+
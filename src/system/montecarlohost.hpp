@@ -7,16 +7,44 @@
 #endif
 
 
-#include "gui/parameters/base_parameters_widget.hpp"
+#include "simulation_parameters.hpp"
 #include "spinsystem.hpp"
+#include "acceptance_table.hpp"
+#include "correlation_accumulator.hpp"
+#include "moments.hpp"
+#include "error_analysis.hpp"
 #include "histogram.hpp"
 #include "lib/enhance.hpp"
+#include "lib/thread_pool.hpp"
 #include "definitions.hpp"
-#include <QDebug>
 #include <cassert>
 #include <cmath>
 #include <iomanip>
 #include <fstream>
+#include <memory>
+#include <random>
+
+
+
+// averages over the recorded samples, as written to the .averaged_data file
+struct Averages
+{
+    double        energy {0};             // <H>
+    double        magnetisation {0};      // <M>
+    double        susceptibility {0};     // chi
+    double        heatCapacity {0};       // Cv
+    unsigned long samples {0};
+
+    // standard errors from blocking (<H>, <M>) and jackknife (chi, Cv)
+    double        energyError {0};
+    double        magnetisationError {0};
+    double        susceptibilityError {0};
+    double        heatCapacityError {0};
+
+    // integrated autocorrelation times in samples, 0.5 for uncorrelated samples
+    double        energyTau {0.5};
+    double        magnetisationTau {0.5};
+};
 
 
 
@@ -24,10 +52,40 @@ class MonteCarloHost
 {
 private:
     Spinsystem           spinsystem {};
-    std::vector<double>  energies {};
-    std::vector<double>  magnetisations {};
+    Moments              moments {};            // of the recorded energies and magnetisations
+    BlockingTree         energyBlocks {};
+    BlockingTree         magnetisationBlocks {};
+    JackknifeBins        jackknifeBins {};
+
+    // time series of the recorded samples, streamed to the .data file if parameters.timeSeries is set
+    std::unique_ptr<std::ofstream> timeSeries {};
+    void record();
 
-    bool acceptance(const double, const double, const double);
+    // configurations of the production run for the averaged G(r) and S(k), created on first use
+    std::unique_ptr<CorrelationAccumulator> correlationAccumulator {};
+
+    AcceptanceTable      acceptanceTable {};
+
+    bool acceptance(const EnergyChange&, const double proposalRatio = 1);
+
+    // parallel sweeps: thread pool and one random number engine per row block
+    std::unique_ptr<enhance::ThreadPool>  threadPool {};
+    std::vector<enhance::Xoshiro256>      engines {};
+    std::vector<enhance::Xoshiro256x4>    vectorEngines {};     // bulk random numbers of the packed sweeps
+    long                                  stepCredit {0};    // steps not yet covered by a sweep or cluster update
+
+    // Wolff updates: visited spins and number of clusters since the last change of the parameters
+    unsigned long long  clusterSizes {0};
+    unsigned long long  clusterUpdates {0};
+
+    // random numbers of this host, seeded in setup() so that hosts can run concurrently
+    enhance::Xoshiro256  engine {};
+
+    void setupThreads(const unsigned int);
+    void splitEngines();
+    void checkerboardSweep();
+    void swendsenWangSweep();
+    void wolffUpdates(const unsigned long);
     
 public:
     void run(const unsigned long&, const bool EQUILMODE = false);
@@ -51,7 +109,13 @@ public:
  */
 
 private:
-    BaseParametersWidget* parameters = Q_NULLPTR;
+    SimulationParameters parameters {};
+    std::shared_ptr<const SimulationParameters> published {};      // set by publish(), taken over by run()
+
+    // replica exchange: own temperature and number of threads instead of those of the parameters widget
+    double        temperature {0};
+    bool          ownTemperature {false};
+    unsigned int  threads {0};
 
 public:
     MonteCarloHost();
@@ -59,15 +123,27 @@ public:
     void operator=(const MonteCarloHost&) = delete;
     ~MonteCarloHost();
     
-    void setParameters(BaseParametersWidget*);
-    void setup();
+    void setParameters(const SimulationParameters&);
+    void publish(std::shared_ptr<const SimulationParameters>);
+    const SimulationParameters& getParameters() const { return parameters; }
+    void setTemperature(const double);
+    void setThreads(const unsigned int);
+    void exchangeTemperature(MonteCarloHost&);
+    void setup(enhance::Xoshiro256& source = enhance::rand_engine);
     void resetSpins();
     void clearRecords();
     
     const Spinsystem& getSpinsystem() const;
     
     void print_data() const;
+    const Moments& getMoments() const { return moments; }
+    Averages getAverages() const;
     void print_averages() const;
-    void print_correlation(Histogram<double>&) const;
-    void print_structureFunction(Histogram<double>&) const;
+    void print_averages(std::ostream&) const;
+    static void print_averagesHeader(std::ostream&);
+    static void print_averagesLine(std::ostream&, const double, const double, const double, const Averages&);
+    void print_correlation(const Histogram<double>&) const;
+    void print_structureFunction(const Histogram<double>&) const;
+    void print_structureFactor(const StructureFactor&) const;
+    void print_correlationAverages() const;
 };
@@ -0,0 +1,318 @@
+#include "multispin_host.hpp"
+
+
+
+void MultiSpinHost::run(const unsigned long& steps, const bool EQUILMODE)
+{
+    // sweeps over all replicas until the steps are covered, a sweep accounts for as many steps as there
+    // are spins in one replica; if !EQUILMODE the energies and magnetisations of all replicas are recorded
+
+    qDebug() << __PRETTY_FUNCTION__;
+
+    if( acceptanceTable.update(parameters.interaction, parameters.magnetic, getTemperature()) )
+    {
+        for( unsigned int c = 0; c < moveClasses; ++c )
+        {
+            const int dBonds = 4 * static_cast<int>(c / 2) - 8;
+            const int dSpins = c % 2 == 1 ? +2 : -2;
+            classAlways[c]    = acceptanceTable.alwaysAccepted(dBonds, dSpins);
+            classThreshold[c] = acceptanceTable.threshold(dBonds, dSpins);
+        }
+    }
+
+    const long spinsPerSweep = lattice.size();
+    stepCredit += steps;
+    while( stepCredit >= spinsPerSweep )
+    {
+        sweep();
+        stepCredit -= spinsPerSweep;
+    }
+
+    if( !EQUILMODE )
+    {
+        std::array<std::int64_t, replicas> bondSums {}, spinSums {};
+        measure(bondSums, spinSums);
+        for( unsigned int r = 0; r < replicas; ++r )
+        {
+            const double energy = -parameters.interaction * bondSums[r] - parameters.magnetic * spinSums[r];
+            const double magnetisation = static_cast<double>(spinSums[r]) / lattice.size();
+            moments[r].add(energy, magnetisation);
+            energyBlocks[r].add(energy);
+            magnetisationBlocks[r].add(magnetisation);
+        }
+    }
+}
+
+
+
+void MultiSpinHost::sweep()
+{
+    // checkerboard sweep of all replicas, parallel over blocks of rows as in Spinsystem::checkerboardSweep()
+
+    const unsigned int threads = std::max(1u, parameters.threads);
+    if( ! threadPool || threadPool->size() != threads )
+    {
+        threadPool = std::make_unique<enhance::ThreadPool>(threads);
+        engines.clear();
+        for( unsigned int i = 0; i < threadPool->size(); ++i ) engines.emplace_back( engine.split() );
+    }
+
+    const unsigned long blocks = height % 2 == 0 ? std::min<unsigned long>(threadPool->size(), height) : 1;
+    for( unsigned short colour = 0; colour < 2; ++colour )
+    {
+        threadPool->parallel_for(blocks, [&](const std::size_t block, const unsigned int)
+        {
+            updateSublattice(colour, block * height / blocks, (block + 1) * height / blocks, engines[block]);
+        });
+    }
+}
+
+
+
+void MultiSpinHost::updateSublattice(const unsigned short colour, const unsigned long firstRow, const unsigned long lastRow, enhance::Xoshiro256& blockEngine)
+{
+    // Metropolis update of the sites of one colour in rows [firstRow, lastRow) in all replicas.
+    // A bit-sliced adder counts the antiparallel neighbours k of the 64 replicas of a site, which together with
+    // the spin gives the move class. Classes that lower the energy flip at once. The others flip where the
+    // replica's uniform number U_r is below the threshold of its class: the bits of U_r are drawn most
+    // significant first, one random word serves all replicas, and the comparison is decided for a replica
+    // as soon as one of its bits differs from the threshold, about 7 words for all 64 replicas.
+
+    for( unsigned long row = firstRow; row < lastRow; ++row )
+    {
+        const unsigned long up   = (row == 0 ? height - 1 : row - 1) * width;
+        const unsigned long down = (row + 1 == height ? 0 : row + 1) * width;
+        for( unsigned long column = (row + colour) % 2; column < width; column += 2 )
+        {
+            const unsigned long id = row * width + column;
+            const std::uint64_t S = lattice[id];
+            const std::uint64_t a = S ^ lattice[up + column];
+            const std::uint64_t b = S ^ lattice[down + column];
+            const std::uint64_t c = S ^ lattice[row * width + (column == 0 ? width - 1 : column - 1)];
+            const std::uint64_t d = S ^ lattice[row * width + (column + 1 == width ? 0 : column + 1)];
+
+            const std::uint64_t sumAB = a ^ b, carryAB = a & b;
+            const std::uint64_t sumCD = c ^ d, carryCD = c & d;
+            const std::uint64_t k0 = sumAB ^ sumCD, carry = sumAB & sumCD;
+            const std::uint64_t k1 = carryAB ^ carryCD ^ carry;
+            const std::uint64_t k2 = carryAB & carryCD;
+
+            const std::uint64_t withK[5] = { ~(k0 | k1 | k2), k0 & ~k1, ~k0 & k1, k0 & k1, k2 };
+
+            std::uint64_t flips = 0;
+            std::uint64_t masks[moveClasses];
+            unsigned int  uncertain[moveClasses];
+            unsigned int  n = 0;
+            for( unsigned int cls = 0; cls < moveClasses; ++cls )
+            {
+                const std::uint64_t mask = withK[cls / 2] & (cls % 2 == 1 ? S : ~S);
+                if( ! mask ) continue;
+                if( classAlways[cls] ) flips |= mask;
+                else
+                {
+                    masks[n] = mask;
+                    uncertain[n++] = cls;
+                }
+            }
+
+            // bit-sliced comparison U_r < threshold of the class of replica r
+            std::uint64_t pending = 0;
+            for( unsigned int i = 0; i < n; ++i ) pending |= masks[i];
+            for( int bit = 63; bit >= 0 && pending; --bit )
+            {
+                std::uint64_t thresholdBits = 0;
+                for( unsigned int i = 0; i < n; ++i )
+                {
+                    if( (classThreshold[uncertain[i]] >> bit) & 1 ) thresholdBits |= masks[i];
+                }
+                const std::uint64_t random = blockEngine();
+                flips   |= pending & thresholdBits & ~random;
+                pending &= ~(random ^ thresholdBits);
+            }
+
+            lattice[id] = S ^ flips;
+        }
+    }
+}
+
+
+
+void MultiSpinHost::measure(std::array<std::int64_t, replicas>& bondSums, std::array<std::int64_t, replicas>& spinSums) const
+{
+    // bond and spin sums of every replica: blocks of 64 site words (the XOR with the right and the lower
+    // neighbour for the bonds) are transposed, then the popcount of row r counts replica r
+
+    const unsigned long total = lattice.size();
+    std::array<std::int64_t, replicas> antiparallel {}, down {};
+
+    for( unsigned long first = 0; first < total; first += 64 )
+    {
+        std::uint64_t spins[64] {}, right[64] {}, below[64] {};
+        for( unsigned long i = 0; i < 64 && first + i < total; ++i )
+        {
+            const unsigned long id = first + i;
+            const unsigned long column = id % width;
+            spins[i] = lattice[id];
+            right[i] = lattice[id] ^ lattice[column + 1 == width ? id + 1 - width : id + 1];
+            below[i] = lattice[id] ^ lattice[id + width < total ? id + width : id + width - total];
+        }
+        transpose(spins);
+        transpose(right);
+        transpose(below);
+        for( unsigned int r = 0; r < replicas; ++r )
+        {
+            down[r] += __builtin_popcountll(spins[r]);
+            antiparallel[r] += __builtin_popcountll(right[r]) + __builtin_popcountll(below[r]);
+        }
+    }
+
+    const std::int64_t N = total;
+    for( unsigned int r = 0; r < replicas; ++r )
+    {
+        bondSums[r] = 2 * N - 2 * antiparallel[r];
+        spinSums[r] = N - 2 * down[r];
+    }
+}
+
+
+
+void MultiSpinHost::transpose(std::uint64_t (&block)[64])
+{
+    // transpose a 64x64 bit matrix in place: afterwards bit i of word r is bit r of word i before
+    // (recursive exchange of the off-diagonal blocks, from 32x32 down to 1x1)
+
+    std::uint64_t mask = 0x00000000ffffffff;
+    for( unsigned int j = 32; j != 0; j >>= 1, mask ^= mask << j )
+    {
+        for( unsigned int k = 0; k < 64; k = ((k | j) + 1) & ~j )
+        {
+            const std::uint64_t t = ((block[k] >> j) ^ block[k | j]) & mask;
+            block[k]     ^= t << j;
+            block[k | j] ^= t;
+        }
+    }
+}
+
+
+
+
+double MultiSpinHost::getTemperature() const
+{
+    return parameters.temperature;
+}
+
+
+MultiSpinHost::MultiSpinHost()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+}
+
+
+MultiSpinHost::~MultiSpinHost()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+}
+
+
+void MultiSpinHost::setParameters(const SimulationParameters& prms)
+{
+    qDebug() << __PRETTY_FUNCTION__;
+
+    parameters = prms;
+}
+
+
+void MultiSpinHost::setup()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+
+    width  = parameters.width;
+    height = parameters.height;
+    engine = enhance::rand_engine.split();
+    threadPool.reset();
+    resetSpins();
+    clearRecords();
+
+    isingLOG("multi-spin: " << replicas << " replicas of " << width << "*" << height << " spins")
+}
+
+
+void MultiSpinHost::resetSpins()
+{
+    // random spins, independently in every replica
+
+    qDebug() << __PRETTY_FUNCTION__;
+
+    lattice.resize(width * height);
+    for( auto& word : lattice ) word = engine();
+}
+
+
+void MultiSpinHost::clearRecords()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+
+    for( auto& M : moments ) M.clear();
+    for( auto& B : energyBlocks ) B.clear();
+    for( auto& B : magnetisationBlocks ) B.clear();
+    stepCredit = 0;
+}
+
+
+Averages MultiSpinHost::getAverages() const
+{
+    // averages over all records of all replicas. The replicas are independent, so the errors are jackknife
+    // errors over the replicas and tau_int is the mean of the blocking analyses of the replicas
+
+    Moments all;
+    for( const auto& M : moments ) all.merge(M);
+    const double T = getTemperature();
+    const double denominator = std::pow(T,2) * std::pow(parameters.width*parameters.height,2);
+    const std::vector<Moments> groups(std::begin(moments), std::end(moments));
+
+    Averages A;
+    A.energy              = all.energy();
+    A.magnetisation       = all.magnetisation();
+    A.susceptibility      = all.magnetisationVariance() / T;
+    A.heatCapacity        = all.energyVariance() / denominator;
+    A.samples             = all.getSamples();
+    A.energyError         = jackknife(groups, [](const Moments& M){ return M.energy(); });
+    A.magnetisationError  = jackknife(groups, [](const Moments& M){ return M.magnetisation(); });
+    A.susceptibilityError = jackknife(groups, [T](const Moments& M){ return M.magnetisationVariance() / T; });
+    A.heatCapacityError   = jackknife(groups, [denominator](const Moments& M){ return M.energyVariance() / denominator; });
+    A.energyTau           = 0;
+    A.magnetisationTau    = 0;
+    for( unsigned int r = 0; r < replicas; ++r )
+    {
+        A.energyTau += energyBlocks[r].tau() / replicas;
+        A.magnetisationTau += magnetisationBlocks[r].tau() / replicas;
+    }
+    return A;
+}
+
+
+void MultiSpinHost::print_averages() const
+{
+    // compute averages over all replicas and save to file, same columns as MonteCarloHost
+
+    qDebug() << __PRETTY_FUNCTION__;
+    isingDEBUG("multi-spin: " << "saving averaged data ...")
+
+    std::string filekeystring = parameters.fileKey;
+    std::string filekey = filekeystring.substr( 0, filekeystring.find_first_of(" ") );
+    filekey.append(".averaged_data");
+
+    std::ofstream FILE;
+    if( ! enhance::fileExists(filekey) )
+    {
+        FILE.open(filekey);
+        MonteCarloHost::print_averagesHeader(FILE);
+    }
+    else
+    {
+        FILE.open(filekey, std::ios::app);
+    }
+    MonteCarloHost::print_averagesLine(FILE, parameters.interaction, getTemperature(), parameters.magnetic, getAverages());
+
+    FILE.close();
+}
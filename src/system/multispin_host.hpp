@@ -0,0 +1,92 @@
+#pragma once
+
+#ifdef QT_NO_DEBUG
+    #ifndef QT_NO_DEBUG_OUTPUT
+        #define QT_NO_DEBUG_OUTPUT
+    #endif
+#endif
+
+
+#include "simulation_parameters.hpp"
+#include "montecarlohost.hpp"
+#include "acceptance_table.hpp"
+#include "moments.hpp"
+#include "error_analysis.hpp"
+#include "spin.hpp"
+#include "lib/enhance.hpp"
+#include "lib/thread_pool.hpp"
+#include "definitions.hpp"
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <fstream>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+
+
+// 64 independent replicas of the lattice in spin-flip mode, multi-spin coded: bit r of the word of a site
+// is the spin of replica r at that site, a set bit is a down spin. A checkerboard Metropolis sweep treats
+// the 64 replicas of a site with a few bitwise operations. Every replica compares against its own random
+// bits, so the replicas stay statistically independent and every record holds 64 samples.
+class MultiSpinHost
+{
+private:
+    static constexpr unsigned int replicas = 64;
+
+    std::vector<std::uint64_t> lattice {};      // one word per site, site-ID = row * width + column
+    unsigned long width  {0};
+    unsigned long height {0};
+
+    std::array<Moments, replicas> moments {};   // of every replica, merged for the averages
+    std::array<BlockingTree, replicas> energyBlocks {};
+    std::array<BlockingTree, replicas> magnetisationBlocks {};
+
+    AcceptanceTable      acceptanceTable {};
+
+    // move classes of a site: c = 2 * antiparallel neighbours + (spin down ? 1 : 0)
+    static constexpr unsigned int moveClasses = 10;
+    std::array<bool, moveClasses>          classAlways {};
+    std::array<std::uint64_t, moveClasses> classThreshold {};
+
+    // parallel sweeps: thread pool and one random number engine per row block
+    std::unique_ptr<enhance::ThreadPool>  threadPool {};
+    std::vector<enhance::Xoshiro256>      engines {};
+    enhance::Xoshiro256                   engine {};
+    long                                  stepCredit {0};
+
+    void sweep();
+    void updateSublattice(const unsigned short, const unsigned long, const unsigned long, enhance::Xoshiro256&);
+    void measure(std::array<std::int64_t, replicas>&, std::array<std::int64_t, replicas>&) const;
+
+    static void transpose(std::uint64_t (&)[64]);
+
+public:
+    void run(const unsigned long&, const bool EQUILMODE = false);
+
+    double getTemperature() const;
+
+
+private:
+    SimulationParameters parameters {};
+
+public:
+    MultiSpinHost();
+    MultiSpinHost(const MultiSpinHost&) = delete;
+    void operator=(const MultiSpinHost&) = delete;
+    ~MultiSpinHost();
+
+    void setParameters(const SimulationParameters&);
+    void setup();
+    void resetSpins();
+    void clearRecords();
+
+    // type of spin id in replica r
+    int getSpinType(const unsigned int r, const unsigned long id) const { return (lattice[id] >> r) & 1 ? -1 : +1; }
+
+    Averages getAverages() const;
+    void print_averages() const;
+};
@@ -0,0 +1,388 @@
+#include "packed_lattice.hpp"
+#include <algorithm>
+
+
+
+bool PackedLattice::supports(const unsigned long _width, const unsigned long _height)
+{
+    // sublattice updates decide whole words at once, so spins of one colour must not be neighbours
+    // across the periodic boundary, which needs an even width and height; a spin must not be its own neighbour
+    return _width >= 2 && _height >= 2 && _width % 2 == 0 && _height % 2 == 0;
+}
+
+
+
+void PackedLattice::assign(const std::vector<Spin>& spins, const unsigned long _width, const unsigned long _height)
+{
+    width  = _width;
+    height = _height;
+    wordsPerRow  = (width + 63) / 64;
+    lastWordMask = width % 64 == 0 ? ~std::uint64_t{0} : (std::uint64_t{1} << (width % 64)) - 1;
+
+    words.assign(height * wordsPerRow, 0);
+    for( unsigned long id = 0; id < spins.size(); ++id )
+    {
+        if( spins[id].getType() == -1 ) flip(id);
+    }
+}
+
+
+
+void PackedLattice::unpack(std::vector<Spin>& spins) const
+{
+    spins.resize(width * height);
+    for( unsigned long id = 0; id < spins.size(); ++id )
+    {
+        spins[id].setType( getType(id) );
+    }
+}
+
+
+
+void PackedLattice::clear()
+{
+    std::vector<std::uint64_t>().swap(words);
+    width = height = wordsPerRow = 0;
+}
+
+
+
+std::int64_t PackedLattice::downSpins() const
+{
+    std::int64_t count = 0;
+    for( const auto W : words ) count += __builtin_popcountll(W);
+    return count;
+}
+
+
+
+std::int64_t PackedLattice::antiparallelBonds() const
+{
+    // bonds to the right and below of every spin, antiparallel where the XOR of the rows is set
+
+    std::int64_t count = 0;
+    std::vector<std::uint64_t> right (wordsPerRow);
+    for( unsigned long row = 0; row < height; ++row )
+    {
+        const std::uint64_t* spins = &words[row * wordsPerRow];
+        const std::uint64_t* down  = &words[(row + 1 == height ? 0 : row + 1) * wordsPerRow];
+        rightNeighbours(spins, right.data());
+        for( unsigned long w = 0; w < wordsPerRow; ++w )
+        {
+            count += __builtin_popcountll(spins[w] ^ right[w]) + __builtin_popcountll(spins[w] ^ down[w]);
+        }
+    }
+    return count;
+}
+
+
+
+void PackedLattice::leftNeighbours(const std::uint64_t* row, std::uint64_t* out) const
+{
+    // bit c of out is the spin in column c - 1, periodic
+
+    const unsigned long last = wordsPerRow - 1;
+    for( unsigned long w = last; w > 0; --w )
+    {
+        out[w] = (row[w] << 1) | (row[w - 1] >> 63);
+    }
+    out[0] = (row[0] << 1) | ((row[last] >> ((width - 1) % 64)) & 1);
+    out[last] &= lastWordMask;
+}
+
+
+
+void PackedLattice::rightNeighbours(const std::uint64_t* row, std::uint64_t* out) const
+{
+    // bit c of out is the spin in column c + 1, periodic
+
+    const unsigned long last = wordsPerRow - 1;
+    for( unsigned long w = 0; w < last; ++w )
+    {
+        out[w] = (row[w] >> 1) | (row[w + 1] << 63);
+    }
+    out[last] = row[last] >> 1;
+    out[last] |= (row[0] & 1) << ((width - 1) % 64);
+}
+
+
+
+namespace
+{
+    // move classes of a single spin flip: c = 2 * antiparallel neighbours + (spin down ? 1 : 0),
+    // the flip changes the bond sum by 4 * (c / 2) - 8 and the spin sum by +2 (down) or -2 (up)
+    constexpr unsigned int flipClasses = 10;
+
+    struct FlipClasses
+    {
+        std::uint64_t always[flipClasses];      // ~0 if class c is always accepted, else 0
+        unsigned int  uncertain[flipClasses];   // classes that need a random number
+        std::uint64_t threshold[flipClasses];   // their acceptance thresholds, scaled to 2^64
+        unsigned int  n;
+    };
+
+    // consecutive words of one or more rows and their neighbour words, all of the same length
+    struct SublatticeChunk
+    {
+        std::uint64_t*       spins;
+        const std::uint64_t* up;
+        const std::uint64_t* down;
+        const std::uint64_t* left;
+        const std::uint64_t* right;
+        const std::uint64_t* candidates;        // sites of the colour to update
+        unsigned long        words;
+        std::uint64_t*       scratch;           // (4 + flipClasses) * words
+    };
+
+
+
+    // Metropolis update of the candidates of a chunk. The antiparallel neighbours are counted by a bit-sliced
+    // adder, which sorts the candidates into move classes. The always accepted classes flip at once. For the
+    // others U < threshold is evaluated bit-sliced, most significant bit first: bit b of one random word is
+    // the next bit of U of the candidate at b, and the comparison is decided for a candidate as soon as a bit
+    // of U differs from the threshold of its class. All words of the chunk are compared in the same loop
+    // iteration, which the compiler vectorises, until no candidate is left undecided.
+    // Every loop below has independent iterations and no branches, the width of the vectors is that of
+    // the instruction set the function is compiled for.
+    inline __attribute__((always_inline)) EnergyChange updateChunk(const SublatticeChunk& C, const FlipClasses& F, enhance::Xoshiro256x4& engine)
+    {
+        const unsigned long W = C.words;
+        std::uint64_t* flips         = C.scratch;
+        std::uint64_t* pending       = flips + W;
+        std::uint64_t* random        = pending + W;
+        std::uint64_t* thresholdBits = random + W;  // threshold bits of the class of every candidate
+        std::uint64_t* masks         = thresholdBits + W;   // F.n * W, class i of word w at i * W + w
+
+        for( unsigned long w = 0; w < W; ++w )
+        {
+            const std::uint64_t S = C.spins[w];
+            const std::uint64_t a = S ^ C.up[w], b = S ^ C.down[w], c = S ^ C.left[w], d = S ^ C.right[w];
+
+            // k = a + b + c + d bit by bit as k0 + 2*k1 + 4*k2
+            const std::uint64_t sumAB = a ^ b, carryAB = a & b;
+            const std::uint64_t sumCD = c ^ d, carryCD = c & d;
+            const std::uint64_t k0 = sumAB ^ sumCD, carry = sumAB & sumCD;
+            const std::uint64_t k1 = carryAB ^ carryCD ^ carry;
+            const std::uint64_t k2 = carryAB & carryCD;
+
+            const std::uint64_t withK[5] = { ~(k0 | k1 | k2), k0 & ~k1 & ~k2, ~k0 & k1, k0 & k1, k2 };
+            const std::uint64_t down = S & C.candidates[w], up = ~S & C.candidates[w];
+
+            std::uint64_t accepted = 0;
+            for( unsigned int cls = 0; cls < flipClasses; ++cls )
+            {
+                accepted |= withK[cls / 2] & (cls % 2 == 1 ? down : up) & F.always[cls];
+            }
+            std::uint64_t undecided = 0;
+            for( unsigned int i = 0; i < F.n; ++i )
+            {
+                const unsigned int cls = F.uncertain[i];
+                masks[i * W + w] = withK[cls / 2] & (cls % 2 == 1 ? down : up);
+                undecided |= masks[i * W + w];
+            }
+            flips[w]   = accepted;
+            pending[w] = undecided;
+        }
+
+        for( int bit = 63; bit >= 0; --bit )
+        {
+            for( unsigned long w = 0; w < W; ++w ) thresholdBits[w] = 0;
+            for( unsigned int i = 0; i < F.n; ++i )
+            {
+                const std::uint64_t plane = -((F.threshold[i] >> bit) & 1);
+                const std::uint64_t* mask = masks + i * W;
+                for( unsigned long w = 0; w < W; ++w ) thresholdBits[w] |= mask[w] & plane;
+            }
+
+            engine.fill(random, W);
+
+            std::uint64_t open = 0;
+            for( unsigned long w = 0; w < W; ++w )
+            {
+                flips[w]   |= pending[w] & thresholdBits[w] & ~random[w];
+                pending[w] &= ~(random[w] ^ thresholdBits[w]);
+                open |= pending[w];
+            }
+            if( ! open ) break;
+        }
+
+        // flip and sum up the change class by class
+        EnergyChange total {};
+        for( unsigned long w = 0; w < W; ++w )
+        {
+            const std::uint64_t S = C.spins[w];
+            const std::uint64_t a = S ^ C.up[w], b = S ^ C.down[w], c = S ^ C.left[w], d = S ^ C.right[w];
+            const std::uint64_t sumAB = a ^ b, carryAB = a & b;
+            const std::uint64_t sumCD = c ^ d, carryCD = c & d;
+            const std::uint64_t k0 = sumAB ^ sumCD, carry = sumAB & sumCD;
+            const std::uint64_t k1 = carryAB ^ carryCD ^ carry;
+            const std::uint64_t k2 = carryAB & carryCD;
+
+            const std::uint64_t f = flips[w];
+            total.bonds += 4 * (__builtin_popcountll(f & k0) + 2 * __builtin_popcountll(f & k1) + 4 * __builtin_popcountll(f & k2)) - 8 * __builtin_popcountll(f);
+            total.spins += 2 * __builtin_popcountll(f & S) - 2 * __builtin_popcountll(f & ~S);
+            C.spins[w] = S ^ f;
+        }
+        return total;
+    }
+
+
+
+    // the same update compiled for the instruction sets worth dispatching to
+    EnergyChange updateChunkGeneric(const SublatticeChunk& C, const FlipClasses& F, enhance::Xoshiro256x4& engine)
+    {
+        return updateChunk(C, F, engine);
+    }
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __attribute__((target("avx2,popcnt")))
+    EnergyChange updateChunkAVX2(const SublatticeChunk& C, const FlipClasses& F, enhance::Xoshiro256x4& engine)
+    {
+        return updateChunk(C, F, engine);
+    }
+
+    __attribute__((target("avx512f,avx512bw,popcnt")))
+    EnergyChange updateChunkAVX512(const SublatticeChunk& C, const FlipClasses& F, enhance::Xoshiro256x4& engine)
+    {
+        return updateChunk(C, F, engine);
+    }
+#endif
+
+
+
+    struct ChunkKernel
+    {
+        const char* name;
+        EnergyChange (*update)(const SublatticeChunk&, const FlipClasses&, enhance::Xoshiro256x4&);
+    };
+
+    const ChunkKernel& chunkKernel()
+    {
+        // picked once, by the instruction sets of the CPU the program runs on
+        static const ChunkKernel kernel = []()
+        {
+        #if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_cpu_init();
+            if( __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") ) return ChunkKernel { "AVX-512", &updateChunkAVX512 };
+            if( __builtin_cpu_supports("avx2") ) return ChunkKernel { "AVX2", &updateChunkAVX2 };
+        #endif
+            return ChunkKernel { "generic", &updateChunkGeneric };
+        }();
+        return kernel;
+    }
+}
+
+
+
+const char* PackedLattice::kernelName()
+{
+    return chunkKernel().name;
+}
+
+
+
+EnergyChange PackedLattice::checkerboardSweep(enhance::ThreadPool& pool, const AcceptanceTable& table, std::vector<enhance::Xoshiro256x4>& engines)
+{
+    // one Metropolis sweep over both sublattices in parallel blocks of rows, block b draws from engines[b],
+    // returns the summed change. The rows around every block are copied before a half-sweep: a neighbouring
+    // block does not change the bits that are read, but it writes the words they are in.
+
+    const unsigned long blocks = std::min<unsigned long>({ pool.size(), height, engines.size() });
+    std::vector<std::uint64_t> halo (2 * blocks * wordsPerRow);
+    std::vector<EnergyChange>  changes (blocks);
+    EnergyChange total {};
+
+    for( unsigned short colour = 0; colour < 2; ++colour )
+    {
+        for( unsigned long block = 0; block < blocks; ++block )
+        {
+            const unsigned long firstRow = block * height / blocks, lastRow = (block + 1) * height / blocks;
+            std::copy_n(&words[(firstRow == 0 ? height - 1 : firstRow - 1) * wordsPerRow], wordsPerRow, &halo[2 * block * wordsPerRow]);
+            std::copy_n(&words[(lastRow == height ? 0 : lastRow) * wordsPerRow], wordsPerRow, &halo[(2 * block + 1) * wordsPerRow]);
+        }
+
+        pool.parallel_for(blocks, [&](const std::size_t block, const unsigned int)
+        {
+            const unsigned long firstRow = block * height / blocks, lastRow = (block + 1) * height / blocks;
+            changes[block] = updateSublattice(colour, firstRow, lastRow, &halo[2 * block * wordsPerRow], &halo[(2 * block + 1) * wordsPerRow], table, engines[block]);
+        });
+
+        for( const auto& C : changes )
+        {
+            total.bonds += C.bonds;
+            total.spins += C.spins;
+        }
+    }
+    return total;
+}
+
+
+
+EnergyChange PackedLattice::updateSublattice(const unsigned short colour, const unsigned long firstRow, const unsigned long lastRow,
+                                             const std::uint64_t* above, const std::uint64_t* below, const AcceptanceTable& table, enhance::Xoshiro256x4& engine)
+{
+    // Metropolis update of all spins of colour (row + column) % 2 in rows [firstRow, lastRow), above and below
+    // are the rows around them, returns the summed change. Rows are handed to the vector kernel in chunks of
+    // at least minimumWords words, so that small lattices fill the vectors as well.
+
+    constexpr unsigned long minimumWords = 16;
+
+    FlipClasses classes {};
+    for( unsigned int cls = 0; cls < flipClasses; ++cls )
+    {
+        const int dBonds = 4 * static_cast<int>(cls / 2) - 8;
+        const int dSpins = cls % 2 == 1 ? +2 : -2;
+        classes.always[cls] = table.alwaysAccepted(dBonds, dSpins) ? ~std::uint64_t{0} : 0;
+        if( ! classes.always[cls] )
+        {
+            classes.uncertain[classes.n] = cls;
+            classes.threshold[classes.n++] = table.threshold(dBonds, dSpins);
+        }
+    }
+
+    const unsigned long rowsPerChunk = std::max<unsigned long>(1, (minimumWords + wordsPerRow - 1) / wordsPerRow);
+    const unsigned long maxWords = std::min(rowsPerChunk, lastRow - firstRow) * wordsPerRow;
+    std::vector<std::uint64_t> left (maxWords), right (maxWords), candidates (maxWords), up (maxWords), down (maxWords);
+    std::vector<std::uint64_t> scratch ((4 + flipClasses) * maxWords);
+
+    EnergyChange total {};
+    for( unsigned long first = firstRow; first < lastRow; first += rowsPerChunk )
+    {
+        const unsigned long last = std::min(first + rowsPerChunk, lastRow);
+        const unsigned long chunkWords = (last - first) * wordsPerRow;
+
+        for( unsigned long row = first; row < last; ++row )
+        {
+            const unsigned long offset = (row - first) * wordsPerRow;
+            leftNeighbours(&words[row * wordsPerRow], &left[offset]);
+            rightNeighbours(&words[row * wordsPerRow], &right[offset]);
+
+            // the width is even, so every word starts with the same colour as the row
+            const std::uint64_t colourMask = (row + colour) % 2 == 0 ? 0x5555555555555555 : 0xaaaaaaaaaaaaaaaa;
+            for( unsigned long w = 0; w < wordsPerRow; ++w )
+            {
+                candidates[offset + w] = colourMask & (w + 1 == wordsPerRow ? lastWordMask : ~std::uint64_t{0});
+            }
+        }
+
+        // rows above and below are consecutive in memory unless the chunk touches the edge of the block
+        const std::uint64_t* upWords   = first > firstRow ? &words[(first - 1) * wordsPerRow] : up.data();
+        const std::uint64_t* downWords = last < lastRow ? &words[(first + 1) * wordsPerRow] : down.data();
+        if( first == firstRow )
+        {
+            std::copy_n(above, wordsPerRow, up.begin());
+            std::copy_n(&words[first * wordsPerRow], chunkWords - wordsPerRow, up.begin() + wordsPerRow);
+        }
+        if( last == lastRow )
+        {
+            std::copy_n(&words[(first + 1) * wordsPerRow], chunkWords - wordsPerRow, down.begin());
+            std::copy_n(below, wordsPerRow, down.begin() + chunkWords - wordsPerRow);
+        }
+
+        const SublatticeChunk chunk { &words[first * wordsPerRow], upWords, downWords, left.data(), right.data(), candidates.data(), chunkWords, scratch.data() };
+        const EnergyChange change = chunkKernel().update(chunk, classes, engine);
+        total.bonds += change.bonds;
+        total.spins += change.spins;
+    }
+    return total;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "spin.hpp"
+#include "acceptance_table.hpp"
+#include "lib/random.hpp"
+#include "lib/thread_pool.hpp"
+#include <cstdint>
+#include <vector>
+
+
+
+// periodic lattice with one bit per spin: row r occupies wordsPerRow consecutive words,
+// column c is bit c % 64 of word c / 64, a set bit is a down spin. Unused bits at the end
+// of a row stay zero. Whole rows are processed word by word, so observables are XOR and
+// popcount passes and sublattice updates decide and flip up to 32 spins per word at once.
+class PackedLattice
+{
+private:
+    std::vector<std::uint64_t> words {};
+    unsigned long width  {0};
+    unsigned long height {0};
+    unsigned long wordsPerRow {0};
+    std::uint64_t lastWordMask {0};     // valid bits of the last word of a row
+
+    void leftNeighbours(const std::uint64_t*, std::uint64_t*) const;
+    void rightNeighbours(const std::uint64_t*, std::uint64_t*) const;
+
+    EnergyChange updateSublattice(const unsigned short, const unsigned long, const unsigned long,
+                                  const std::uint64_t*, const std::uint64_t*, const AcceptanceTable&, enhance::Xoshiro256x4&);
+
+public:
+    static bool supports(const unsigned long, const unsigned long);
+
+    void assign(const std::vector<Spin>&, const unsigned long, const unsigned long);
+    void unpack(std::vector<Spin>&) const;
+    void clear();
+
+    inline int  getType(const unsigned long) const;
+    inline void flip(const unsigned long);
+
+    std::int64_t downSpins() const;
+    std::int64_t antiparallelBonds() const;
+
+    EnergyChange checkerboardSweep(enhance::ThreadPool&, const AcceptanceTable&, std::vector<enhance::Xoshiro256x4>&);
+
+    static const char* kernelName();     // instruction set of the sublattice update
+};
+
+
+
+inline int PackedLattice::getType(const unsigned long id) const
+{
+    const unsigned long row = id / width, column = id % width;
+    return (words[row * wordsPerRow + column / 64] >> (column % 64)) & 1 ? -1 : +1;
+}
+
+
+
+inline void PackedLattice::flip(const unsigned long id)
+{
+    const unsigned long row = id / width, column = id % width;
+    words[row * wordsPerRow + column / 64] ^= std::uint64_t{1} << (column % 64);
+}
+
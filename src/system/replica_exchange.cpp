@@ -0,0 +1,219 @@
+#include "replica_exchange.hpp"
+
+
+
+void ReplicaExchange::run(const unsigned long& steps, const bool EQUILMODE)
+{
+    // one round: every replica does the given number of steps at its current temperature
+    // (and records a sample if !EQUILMODE), then neighbouring temperatures are offered an exchange
+
+    qDebug() << __PRETTY_FUNCTION__;
+    Q_CHECK_PTR(threadPool);
+    assert( ! replicas.empty() );
+
+    threadPool->parallel_for(replicas.size(), [&](const std::size_t i, const unsigned int)
+    {
+        replicas[i]->run(steps, EQUILMODE);
+    });
+
+    exchange();
+    ++rounds;
+
+    // the ladder may only move while equilibrating, production needs fixed temperatures
+    if( EQUILMODE && adaptive && rounds % 100 == 0 )
+    {
+        adaptLadder();
+    }
+}
+
+
+
+void ReplicaExchange::exchange()
+{
+    // offer exchanges to the pairs (k, k+1) with k even and k odd in alternate rounds
+
+    for( unsigned int k = rounds % 2; k + 1 < temperatures.size(); k += 2 )
+    {
+        MonteCarloHost& lower = *replicas[replicaAt[k]];
+        MonteCarloHost& upper = *replicas[replicaAt[k+1]];
+        const double delta = (1/temperatures[k] - 1/temperatures[k+1]) * (lower.getSpinsystem().getHamiltonian() - upper.getSpinsystem().getHamiltonian());
+
+        ++swapAttempts[k];
+        if( delta >= 0 || enhance::randomCanonical(engine) < std::exp(delta) )
+        {
+            lower.exchangeTemperature(upper);
+            std::swap(replicaAt[k], replicaAt[k+1]);
+            ++swapAccepted[k];
+            isingDEBUG("replica exchange: " << "swapped T = " << temperatures[k] << " and T = " << temperatures[k+1])
+        }
+    }
+}
+
+
+
+void ReplicaExchange::adaptLadder()
+{
+    // move the inner temperatures towards equal swap rates of all pairs: the spacing of a pair
+    // shrinks where exchanges are rare and grows where they are frequent, the ends of the ladder stay.
+    // Damped by the square root, so that a few adaptations converge without oscillating.
+
+    if( temperatures.size() < 3 ) return;
+
+    std::vector<double> spacing (temperatures.size() - 1);
+    double total = 0;
+    for( unsigned int k = 0; k < spacing.size(); ++k )
+    {
+        spacing[k] = (temperatures[k+1] - temperatures[k]) * std::sqrt(getSwapRate(k) + 0.05);
+        total += spacing[k];
+    }
+    const double span = temperatures.back() - temperatures.front();
+    for( unsigned int k = 0; k + 2 < temperatures.size(); ++k )
+    {
+        temperatures[k+1] = temperatures[k] + spacing[k] * span / total;
+    }
+
+    std::stringstream ladder;
+    for( unsigned int k = 0; k < temperatures.size(); ++k )
+    {
+        replicas[replicaAt[k]]->setTemperature(temperatures[k]);
+        ladder << temperatures[k] << " ";
+    }
+    std::fill(std::begin(swapAttempts), std::end(swapAttempts), 0);
+    std::fill(std::begin(swapAccepted), std::end(swapAccepted), 0);
+    isingDEBUG("replica exchange: " << "adapted ladder: " << ladder.str())
+}
+
+
+
+double ReplicaExchange::getSwapRate(const unsigned int k) const
+{
+    // fraction of accepted exchanges of the pair (k, k+1)
+    return swapAttempts[k] > 0 ? static_cast<double>(swapAccepted[k]) / swapAttempts[k] : 0;
+}
+
+
+
+
+ReplicaExchange::ReplicaExchange()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+}
+
+
+ReplicaExchange::~ReplicaExchange()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+}
+
+
+void ReplicaExchange::setParameters(const SimulationParameters& prms)
+{
+    qDebug() << __PRETTY_FUNCTION__;
+
+    parameters = prms;
+    // the replicas share the file key, only their averages are written; a correlation analysis per replica
+    // would follow a lattice that changes temperature with every swap
+    parameters.timeSeries = false;
+    parameters.correlationFreq = 0;
+}
+
+
+void ReplicaExchange::setup(const std::vector<double>& ladder)
+{
+    // one replica with a random lattice per temperature, the threads are shared among the replicas
+
+    qDebug() << __PRETTY_FUNCTION__;
+    assert( ! ladder.empty() );
+
+    temperatures = ladder;
+    const unsigned int threads = std::max(1u, parameters.threads);
+    const unsigned int poolSize = std::min<unsigned int>(threads, temperatures.size());
+
+    replicas.clear();
+    replicaAt.clear();
+    for( unsigned int k = 0; k < temperatures.size(); ++k )
+    {
+        replicas.emplace_back( std::make_unique<MonteCarloHost>() );
+        replicas.back()->setParameters(parameters);
+        replicas.back()->setTemperature(temperatures[k]);
+        replicas.back()->setThreads(std::max(1u, threads / poolSize));
+        replicas.back()->setup();
+        replicaAt.push_back(k);
+    }
+
+    if( ! threadPool || threadPool->size() != poolSize )
+    {
+        threadPool = std::make_unique<enhance::ThreadPool>(poolSize);
+    }
+    engine = enhance::rand_engine.split();
+    rounds = 0;
+    clearRecords();
+
+    isingLOG("replica exchange: " << temperatures.size() << " replicas on " << poolSize << " threads")
+}
+
+
+void ReplicaExchange::setAdaptive(const bool flag)
+{
+    qDebug() << __PRETTY_FUNCTION__;
+    adaptive = flag;
+}
+
+
+void ReplicaExchange::clearRecords()
+{
+    qDebug() << __PRETTY_FUNCTION__;
+
+    for( auto& replica : replicas ) replica->clearRecords();
+    swapAttempts.assign(temperatures.size() > 1 ? temperatures.size() - 1 : 0, 0);
+    swapAccepted.assign(swapAttempts.size(), 0);
+}
+
+
+void ReplicaExchange::print_averages() const
+{
+    // one row of averaged data per temperature, in the order of the ladder
+
+    qDebug() << __PRETTY_FUNCTION__;
+
+    for( unsigned int k = 0; k < temperatures.size(); ++k )
+    {
+        getReplica(k).print_averages();
+    }
+}
+
+
+void ReplicaExchange::print_swapStatistics() const
+{
+    // save to file:  T_k  T_k+1  attempts  accepted  rate
+
+    qDebug() << __PRETTY_FUNCTION__;
+    isingDEBUG("replica exchange: " << "saving swap statistics ...")
+
+    std::string filekeystring = parameters.fileKey;
+    std::string filekey = filekeystring.substr( 0, filekeystring.find_first_of(" ") );
+    filekey.append(".swap_statistics");
+
+    std::ofstream FILE;
+    FILE.open(filekey);
+
+    // print header line
+    FILE << std::setw(10) << "# T_k"
+         << std::setw(10) << "T_k+1"
+         << std::setw(14) << "attempts"
+         << std::setw(14) << "accepted"
+         << std::setw(12) << "rate"
+         << '\n';
+
+    for( unsigned int k = 0; k < swapAttempts.size(); ++k )
+    {
+        FILE << std::setw(10) << std::fixed << std::setprecision(4) << temperatures[k]
+             << std::setw(10) << std::fixed << std::setprecision(4) << temperatures[k+1]
+             << std::setw(14) << swapAttempts[k]
+             << std::setw(14) << swapAccepted[k]
+             << std::setw(12) << std::fixed << std::setprecision(4) << getSwapRate(k)
+             << '\n';
+    }
+
+    FILE.close();
+}
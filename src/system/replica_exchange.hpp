@@ -0,0 +1,74 @@
+#pragma once
+
+#ifdef QT_NO_DEBUG
+    #ifndef QT_NO_DEBUG_OUTPUT
+        #define QT_NO_DEBUG_OUTPUT
+    #endif
+#endif
+
+
+#include "simulation_parameters.hpp"
+#include "montecarlohost.hpp"
+#include "lib/enhance.hpp"
+#include "lib/thread_pool.hpp"
+#include "definitions.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+
+
+// Parallel tempering: one MonteCarloHost per temperature of a ladder, advanced concurrently on a thread pool.
+// After every round neighbouring temperatures are offered an exchange with probability
+//     min(1, exp( (1/T_k - 1/T_k+1) * (H_k - H_k+1) ))
+// An exchange swaps the temperatures (and the records taken at them) of two hosts, never their lattices.
+class ReplicaExchange
+{
+private:
+    std::vector<std::unique_ptr<MonteCarloHost>> replicas {};
+    std::vector<double>        temperatures {};     // the ladder
+    std::vector<unsigned int>  replicaAt {};        // replica currently at temperature k
+
+    // swap statistics of the pairs (k, k+1)
+    std::vector<unsigned long> swapAttempts {};
+    std::vector<unsigned long> swapAccepted {};
+
+    std::unique_ptr<enhance::ThreadPool> threadPool {};
+    enhance::Xoshiro256 engine {};
+    unsigned long   rounds {0};
+    bool            adaptive {false};
+
+    void exchange();
+    void adaptLadder();
+
+public:
+    void run(const unsigned long&, const bool EQUILMODE = false);
+
+    const auto& getTemperatures() const { return temperatures; }
+    const MonteCarloHost& getReplica(const unsigned int k) const { return *replicas[replicaAt[k]]; }
+    double getSwapRate(const unsigned int) const;
+
+
+private:
+    SimulationParameters parameters {};
+
+public:
+    ReplicaExchange();
+    ReplicaExchange(const ReplicaExchange&) = delete;
+    void operator=(const ReplicaExchange&) = delete;
+    ~ReplicaExchange();
+
+    void setParameters(const SimulationParameters&);
+    void setup(const std::vector<double>&);
+    void setAdaptive(const bool);
+    void clearRecords();
+
+    void print_averages() const;
+    void print_swapStatistics() const;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "definitions.hpp"
+#include <string>
+
+
+
+// plain copy of everything a simulation needs from the parameter widgets. The engine owns one and
+// never reads a widget: the GUI takes a snapshot on its own thread and hands it over, either directly
+// while nothing runs or through MonteCarloHost::publish(), which run() takes over before its next step.
+struct SimulationParameters
+{
+    // system
+    unsigned long width  {100};
+    unsigned long height {100};
+    double        interaction {1};     // J
+    double        magnetic {0};        // B
+    double        temperature {1};     // T
+    bool          spinExchange {false};        // constrained mode
+    double        ratio {0.5};                 // fraction of up spins in spin-exchange mode
+    bool          wavelengthPattern {false};
+    int           wavelength {1};
+
+    // update scheme
+    ALGORITHM     algorithm {ALGORITHM::Metropolis};
+    unsigned int  threads {1};
+    bool          replicaExchange {false};
+    bool          adaptLadder {false};
+    bool          multiSpin {false};
+
+    // runs and output
+    unsigned long stepsEquil {0};
+    unsigned long stepsProd {0};
+    unsigned int  printFreq {1};
+    unsigned int  correlationFreq {0};     // samples between two configurations of the averaged G(r), S(k); 0: none
+    bool          timeSeries {false};      // stream every sample to the .data file while it is recorded, opt-in
+    std::string   fileKey {};
+};
@@ -1,35 +1,37 @@
 #pragma once
 
-#include "lib/enhance.hpp"
-#include <vector>
-#include <functional>
+#include <cstdint>
 
 
+// a single lattice site, stored as one signed byte so that the Spinsystem
+// can keep all spins in one contiguous array; neighbours are not stored
+// but found by index arithmetic in Spinsystem
 class Spin
 {
 
-    unsigned int  ID {0};
-    int           type {1};
-    std::vector<std::reference_wrapper<Spin>> neighbours {};
+    std::int8_t  type {1};
 
 public:
-    Spin(unsigned int, int);
+    Spin() = default;
+    explicit Spin(int);
 
     void setType(int);
-    void setNeighbours(std::vector<std::reference_wrapper<Spin>>&);
 
-    auto  getID()   const { return ID; }
-    auto  getType() const { return type; }
-    auto& getNeighbours() { return neighbours; }
-
-    Spin& getRandomNeighbour();
+    auto getType() const { return static_cast<int>(type); }
 
     void flip();
 
-    int sumNeighbours() const;
-    int sumOppositeNeighbours() const;
-
 };
 
+static_assert( sizeof(Spin) == 1, "Spin must stay one byte wide to keep the lattice dense" );
+
 
 
+// change of the two integer sums a move causes: bonds = sum_<ij> s_i*s_j and spins = sum_i s_i,
+// the energy change is dE = -J * bonds - B * spins. Also summed over blocks and sweeps, which exceeds
+// the range of int on large lattices
+struct EnergyChange
+{
+    std::int64_t bonds {0};
+    std::int64_t spins {0};
+};
@@ -2,152 +2,242 @@
 
 
 
-double Spinsystem::localEnergyInteraction(const Spin& _spin) const
+constexpr unsigned long Spinsystem::noBond;
+constexpr unsigned long Move::none;
+
+
+
+void Spinsystem::computeHamiltonian()
 {
-    /* Aufgabe 1.2:
+    /* Aufgabe 1.3:
      *
-     * input:    Ein spezifischer Spin
-     * return:   Der Beitrag zum Wechselwirkungsterm im Hamiltonian durch diesen Spin
-     * Funktion: Berechnung des return Wertes
+     * input:    /
+     * return:   /
+     * Funktion: Berechnung der ganzzahligen Summen, aus denen sich der 
+     *           Hamiltonian des Systems bei gegebener Spinkonfiguration 
+     *           ergibt, und Abspeicherung in den Membervariablen 
+     *           "bondSum" und "spinSum".
      */
 
-    return -getInteraction() * _spin.sumNeighbours();
+    if( packed )
+    {
+        // popcount passes over the rows: 2N bonds of which the antiparallel ones count -1
+        const std::int64_t total = getSize();
+        bondSum = 2 * total - 2 * packedSpins.antiparallelBonds();
+        spinSum = total - 2 * packedSpins.downSpins();
+        classesValid = false;
+        return;
+    }
+
+    std::int64_t neighbourSum = 0;
+    spinSum = 0;
+    for( unsigned long id = 0; id < spins.size(); ++id )
+    {
+        neighbourSum += sumNeighbours(id);
+        spinSum += spins[id].getType();
+    }
+    // every bond has been counted from both of its spins
+    bondSum = neighbourSum / 2;
+
+    if( getSpinExchange() ) computeInterface();
+    classesValid = false;
 }
 
 
 
-double Spinsystem::localEnergyMagnetic(const Spin& _spin) const
+void Spinsystem::computeInterface()
 {
-    /* Aufgabe 1.2:
-     *
-     * input:    Ein spezifischer Spin
-     * return:   Der Beitrag zum magnetischen Term im Hamiltonian durch diesen Spin
-     * Funktion: Berechnung des return Wertes.
-     */
+    // rebuild the list of antiparallel bonds from scratch
 
-    return -getMagnetic() * _spin.getType();
+    interfaceBonds.clear();
+    interfacePosition.assign(2 * spins.size(), noBond);
+    for( unsigned long bond = 0; bond < interfacePosition.size(); ++bond )
+    {
+        updateInterface(bond, bondPartner(bond));
+    }
 }
 
 
 
-void Spinsystem::computeHamiltonian()
+void Spinsystem::updateInterface(const unsigned long bond, const unsigned long partner)
 {
-    /* Aufgabe 1.3:
-     *
-     * input:    /
-     * return:   /
-     * Funktion: Berechnung des gesamten Hamiltonian des Systems
-     *           bei gegebener Spinkonfiguration und Abspeicherung 
-     *           dieses Wertes in der Membervariable "Hamiltonian".
-     */
+    // insert or remove a bond from the interface list according to the current spins, O(1)
+
+    const bool antiparallel = spins[bond / 2].getType() != spins[partner].getType();
+    const bool listed = interfacePosition[bond] != noBond;
 
-    Hamiltonian = 0;
-    for( const auto& S : spins )
+    if( antiparallel && ! listed )
     {
-        Hamiltonian += localEnergyInteraction(S) / 2 + localEnergyMagnetic(S);
+        interfacePosition[bond] = interfaceBonds.size();
+        interfaceBonds.push_back(bond);
+    }
+    else if( ! antiparallel && listed )
+    {
+        // move the last entry into the gap
+        const unsigned long position = interfacePosition[bond];
+        interfaceBonds[position] = interfaceBonds.back();
+        interfacePosition[interfaceBonds[position]] = position;
+        interfaceBonds.pop_back();
+        interfacePosition[bond] = noBond;
     }
 }
 
 
 
-void Spinsystem::flip()
+void Spinsystem::updateInterfaceAround(const unsigned long id)
+{
+    // update the four bonds of spin id: its own bonds to the right and below,
+    // the bond to the right of the left neighbour and the one below the upper neighbour
+
+    const auto N = neighbours(id);
+    updateInterface(2 * id, N[1]);
+    updateInterface(2 * id + 1, N[2]);
+    updateInterface(2 * N[3], id);
+    updateInterface(2 * N[0] + 1, id);
+}
+
+
+
+void Spinsystem::computeClasses()
+{
+    // sort all spins into the classes of the n-fold way
+
+    for( auto& members : classMembers ) members.clear();
+    classPosition.resize(spins.size());
+    classOf.resize(spins.size());
+    for( unsigned long id = 0; id < spins.size(); ++id )
+    {
+        const unsigned int c = spinClass(id);
+        classOf[id] = c;
+        classPosition[id] = classMembers[c].size();
+        classMembers[c].push_back(id);
+    }
+    classesValid = true;
+}
+
+
+
+void Spinsystem::updateClass(const unsigned long id)
+{
+    // move spin id into the class of its current environment, O(1)
+
+    const unsigned int newClass = spinClass(id);
+    const unsigned int oldClass = classOf[id];
+    if( newClass == oldClass ) return;
+
+    // move the last member of the old class into the gap
+    auto& from = classMembers[oldClass];
+    const unsigned long position = classPosition[id];
+    from[position] = from.back();
+    classPosition[from[position]] = position;
+    from.pop_back();
+
+    classOf[id] = newClass;
+    classPosition[id] = classMembers[newClass].size();
+    classMembers[newClass].push_back(id);
+}
+
+
+
+double Spinsystem::getHamiltonian() const
+{
+    // H = -J sum_<ij> s_i*s_j - B sum_i s_i
+
+    return -getInteraction() * bondSum - getMagnetic() * spinSum;
+}
+
+
+
+Move Spinsystem::propose()
 {
     /* Aufgabe 1.4:
      *
      * input:    /
-     * return:   /
+     * return:   Vorgeschlagener Zug
      * Funktion: - Im spin-flip Modus:
-     *              Auswahl eines zufälligen Spins, Flip dieses Spins, 
-     *              Update des Hamiltonian, Abspeichern dieses Spins in
-     *              der Membervariable lastFlipped
+     *              Auswahl eines zufälligen Spins, Berechnung der
+     *              Energieänderung, die sein Flip bewirken würde
      *           - Im spin-exchange Modus:
      *              Auswahl eines zufälligen Spins und eines weiteren, 
      *              zufälligen, Nachbarspins mit entgegengesetzer Ausrichtung, 
-     *              Flip dieser beiden Spins, Update des Hamiltonian, Abspeichern
-     *              der geflippten Spins in der Membervariable lastFlipped
+     *              Berechnung der Energieänderung ihres Austauschs
+     *           Die Spins werden dabei nicht verändert.
      */
 
-    lastFlipped.clear(); // contains ID's of spins that have been flipped in last move
-    double localEnergy_before = 0;
-    double localEnergy_after = 0;
+    assert( ! packed );
+    Move move {};
 
     if( ! getSpinExchange() )
     {
-        // find random spin
-        unsigned int randomSpinID = enhance::randomInt(0, spins.size() - 1);
-        lastFlipped.emplace_back( randomSpinID );
-        // flip spin
-        localEnergy_before = localEnergyInteraction( spins[randomSpinID] ) + localEnergyMagnetic( spins[randomSpinID] );
-        spins[randomSpinID].flip();
-        localEnergy_after = localEnergyInteraction( spins[randomSpinID] ) + localEnergyMagnetic( spins[randomSpinID] );
-        // update Hamiltonian
-        Hamiltonian += localEnergy_after - localEnergy_before;
+        // find random spin, all bonds of this spin would change sign
+        move.spin = enhance::randomBounded(spins.size(), engine);
+        move.change.bonds = -2 * sumNeighbours(move.spin);
+        move.change.spins = -2 * spins[move.spin].getType();
     }
-    else
+    else if( ! interfaceBonds.empty() )
     {
-        // find random spin
-        unsigned int randomSpinID = enhance::randomInt(0, spins.size() - 1);
-        do
-        {
-            randomSpinID = enhance::randomInt(0, spins.size() - 1);
-        }while( spins[randomSpinID].sumOppositeNeighbours() == 0 );
-        // find random neighbour
-        unsigned int randomNeighbourID = spins[randomSpinID].getRandomNeighbour().getID();
-        do
-        {
-            randomNeighbourID = spins[randomSpinID].getRandomNeighbour().getID();
-        }while( spins[randomSpinID].getType() == spins[randomNeighbourID].getType() );
-        // flip spins
-        lastFlipped.emplace_back(randomSpinID);
-        lastFlipped.emplace_back(randomNeighbourID);
-        localEnergy_before = localEnergyInteraction(spins[randomSpinID]) + localEnergyInteraction(spins[randomNeighbourID]);
-        spins[randomSpinID].flip();
-        spins[randomNeighbourID].flip();
-        localEnergy_after = localEnergyInteraction(spins[randomSpinID]) + localEnergyInteraction(spins[randomNeighbourID]);
-        // update Hamiltonian
-        Hamiltonian += localEnergy_after - localEnergy_before;
+        // pick a random antiparallel bond from the interface list, O(1) however small the interface is
+        const unsigned long bond = interfaceBonds[ enhance::randomBounded(interfaceBonds.size(), engine) ];
+        move.spin    = bond / 2;
+        move.partner = bondPartner(bond);
+        move.change.bonds = exchangeBonds(move.spin, move.partner);
+        // the reverse move is picked from the new list, which has change.bonds / 2 antiparallel bonds less,
+        // so q(reverse)/q(move) = n / n'
+        move.proposalRatio = static_cast<double>(interfaceBonds.size()) / (static_cast<long>(interfaceBonds.size()) - move.change.bonds / 2);
     }
-    
-    std::stringstream tmp;
-    for(const auto& spinID: lastFlipped) tmp <<  spinID << " ";
-    isingDEBUG("spinsystem: " << "flipping spin: " << tmp.str())
+    // else: no antiparallel bond left, nothing to exchange
 
+    return move;
 }
 
 
 
-void Spinsystem::flip_back()
+void Spinsystem::commit(const Move& move)
 {
-     /* Aufgabe 1.4:
+    /* Aufgabe 1.4:
      *
-     * input:    /
+     * input:    move: mit propose() vorgeschlagener, angenommener Zug
      * return:   /
-     * Funktion: Macht den gesamten in flip() durchgeführten Prozess rückgängig. 
+     * Funktion: Flip der Spins des Zuges, Update des Hamiltonian. 
      */
 
-    double localEnergy_before = 0;
-    double localEnergy_after = 0;
-    
-    for( const auto& id: lastFlipped )
+    assert( ! packed );
+    if( move.spin == Move::none ) return;
+
+    spins[move.spin].flip();
+    if( move.partner != Move::none )
     {
-        localEnergy_before += localEnergyInteraction( spins[id] ) + localEnergyMagnetic( spins[id] );
+        spins[move.partner].flip();
+        updateInterfaceAround(move.spin);
+        updateInterfaceAround(move.partner);
     }
-    // flip spins
-    for( const auto& id: lastFlipped )
+    classesValid = false;
+
+    // update Hamiltonian
+    bondSum += move.change.bonds;
+    spinSum += move.change.spins;
+
+    isingDEBUG("spinsystem: " << "flipping spin: " << move.spin << (move.partner != Move::none ? " " + std::to_string(move.partner) : std::string()))
+}
+
+
+
+int Spinsystem::exchangeBonds(const unsigned long id, const unsigned long partner) const
+{
+    // change of the bond sum if the antiparallel neighbours id and partner are exchanged: their bonds to other
+    // spins change sign, the bond between both does not and is left out (it is counted twice where width or
+    // height is 2), as are bonds of a spin to itself
+
+    int change = 0;
+    for( const auto N : neighbours(id) )
     {
-        spins[id].flip();
+        if( N != partner && N != id ) change -= 2 * spins[id].getType() * spins[N].getType();
     }
-    for( const auto& id: lastFlipped )
+    for( const auto N : neighbours(partner) )
     {
-        localEnergy_after += localEnergyInteraction( spins[id] ) + localEnergyMagnetic( spins[id] );
+        if( N != id && N != partner ) change -= 2 * spins[partner].getType() * spins[N].getType();
     }
-    // update Hamiltonian
-    Hamiltonian += localEnergy_after - localEnergy_before;
-
-    std::stringstream tmp;
-    for(const auto& spinID: lastFlipped) tmp <<  spinID << " ";
-    isingDEBUG("spinsystem: " << "flipping back: " << tmp.str())
-
+    return change;
 }
 
 
@@ -162,17 +252,121 @@ double Spinsystem::getMagnetisation() const
      *           konfiguration.  
      */
 
-    int sum = 0;
+    // every update keeps spinSum up to date, so no spin has to be visited here;
+    // debug builds compare it with a full count at the end of MonteCarloHost::run()
+    return static_cast<double>(spinSum) / getSize();
+}
+
+
+
+std::int64_t Spinsystem::countSpins() const
+{
+    // sum_i s_i counted from the lattice in either storage, O(N)
+
+    if( packed ) return static_cast<std::int64_t>(getSize()) - 2 * packedSpins.downSpins();
+
+    std::int64_t sum = 0;
     for( const auto& S: spins)
     {
         sum += S.getType();
     }
-    return static_cast<double>(sum) / spins.size();
+    return sum;
+}
+
+
+
+void Spinsystem::checkerboardSweep(enhance::ThreadPool& pool, const AcceptanceTable& table, std::vector<enhance::Xoshiro256x4>& engines)
+{
+    // one sweep in spin-flip mode on the packed lattice, by the same rules as the dense checkerboardSweep();
+    // the acceptance is decided by the vector kernel of the packed lattice, block b draws from engines[b]
+
+    assert( packed && ! getSpinExchange() );
+    classesValid = false;
+    const EnergyChange change = packedSpins.checkerboardSweep(pool, table, engines);
+    bondSum += change.bonds;
+    spinSum += change.spins;
+}
+
+
+
+bool Spinsystem::setPacked(const bool flag)
+{
+    // switch between the dense and the bit-packed storage of the lattice, returns whether it is packed now.
+    // Packing needs an even width and height and spin-flip mode; the dense lattice and all workspaces are
+    // released, so a packed system needs one bit per spin. The run switches the storage on its own thread
+    // when it takes over new parameters, readers on other threads are kept out by lockStorage().
+
+    if( flag == packed ) return packed;
+    std::lock_guard<std::mutex> lock(storageMutex);
+
+    if( flag )
+    {
+        if( getSpinExchange() || ! PackedLattice::supports(width, height) ) return false;
+        packedSpins.assign(spins, width, height);
+        std::vector<Spin>().swap(spins);
+        releaseWorkspaces();
+        packed = true;
+        isingDEBUG("spinsystem: " << "packed lattice, " << getSize() / 8 << " bytes")
+    }
+    else
+    {
+        packedSpins.unpack(spins);
+        packedSpins.clear();
+        packed = false;
+        isingDEBUG("spinsystem: " << "unpacked lattice")
+    }
+    classesValid = false;
+    return packed;
+}
+
+
+
+void Spinsystem::allocateClusterWorkspace()
+{
+    // sized for the current lattice and reused by every wolffUpdate() and swendsenWangSweep()
+
+    cluster.clear();
+    cluster.reserve(spins.size());
+    inCluster.assign((spins.size() + 63) / 64, 0);
+    clusterParent.assign(spins.size() + 1, 0);
+    clusterRoot.assign(spins.size(), 0);
+    clusterFlip.assign(spins.size(), 0);
+}
+
+
+
+void Spinsystem::releaseWorkspaces()
+{
+    // free the memory of the cluster and n-fold way workspaces, they are rebuilt when needed
+
+    std::vector<unsigned long>().swap(cluster);
+    std::vector<std::uint64_t>().swap(inCluster);
+    std::vector<unsigned long>().swap(clusterParent);
+    std::vector<unsigned long>().swap(clusterRoot);
+    std::vector<std::uint8_t>().swap(clusterFlip);
+    for( auto& members : classMembers ) std::vector<unsigned long>().swap(members);
+    std::vector<unsigned long>().swap(classPosition);
+    std::vector<std::uint8_t>().swap(classOf);
+    classesValid = false;
+}
+
+
+
+int Spinsystem::sumNeighbours(const unsigned long _id) const
+{
+    // return sum s_i*s_j, where s_i is spin _id and s_j are all neighbours of this spin
+
+    int sum = 0;
+    for( const auto N: neighbours(_id) )
+    {
+        if( N != _id ) sum += spins[N].getType();
+    }
+    return spins[_id].getType() * sum;
 }
 
 
 
-double Spinsystem::distance(const Spin& _spin1, const Spin& _spin2) const
+double Spinsystem::distance(const unsigned long _id1, const unsigned long _id2) const
 {
     /* Aufgabe 1.6:
      *
@@ -182,16 +376,16 @@ double Spinsystem::distance(const Spin& _spin1, const Spin& _spin2) const
      * 
      */
 
-    isingDEBUG("spinsystem: " << "computing distance between spins" << _spin1.getID() << "," << _spin2.getID() )
+    isingDEBUG("spinsystem: " << "computing distance between spins" << _id1 << "," << _id2 )
 
     // step 1: get location of spin1 and spin2:
     int spin1_row, spin1_col, spin2_row, spin2_col;
 
-    spin1_row = _spin1.getID() / getWidth();
-    spin1_col = _spin1.getID() % getWidth();
+    spin1_row = _id1 / width;
+    spin1_col = _id1 % width;
    
-    spin2_row = _spin2.getID() / getWidth();
-    spin2_col = _spin2.getID() % getWidth();
+    spin2_row = _id2 / width;
+    spin2_col = _id2 % width;
 
     isingDEBUG("            " << " at positions (" << spin1_row << ',' << spin1_col << ") and (" << spin2_row << ' ' << spin2_col << ')')
 
@@ -199,15 +393,15 @@ double Spinsystem::distance(const Spin& _spin1, const Spin& _spin2) const
     int x, y;
 
     x = std::abs( spin2_col - spin1_col );
-    if( x > static_cast<int>(getWidth() / 2) )   
+    if( x > static_cast<int>(width / 2) )   
     {
-        x = x - getWidth();     // pbc 
+        x = x - width;     // pbc 
     }
     y = std::abs( spin2_row - spin1_row );
 
-    if( y > static_cast<int>(getHeight() / 2) )
+    if( y > static_cast<int>(height / 2) )
     {
-        y = y - getHeight();    // pbc
+        y = y - height;    // pbc
     }
 
     // step 3: compute norm of vector and return it
@@ -226,67 +420,59 @@ double Spinsystem::distance(const Spin& _spin1, const Spin& _spin2) const
 
 unsigned long Spinsystem::getHeight() const 
 { 
-    Q_CHECK_PTR(parameters); 
-    return parameters->getHeight(); 
+    return height; 
 }
 
 
 unsigned long Spinsystem::getWidth() const 
 { 
-    Q_CHECK_PTR(parameters); 
-    return parameters->getWidth(); 
+    return width; 
 }
 
 
 double Spinsystem::getInteraction() const 
 { 
-    Q_CHECK_PTR(parameters); 
-    return parameters->getInteraction(); 
+    return parameters.interaction; 
 }
 
 
 double Spinsystem::getMagnetic() const 
 { 
-    Q_CHECK_PTR(parameters); 
-    return parameters->getMagnetic(); 
+    return parameters.magnetic; 
 }
 
 
 bool Spinsystem::getSpinExchange() const 
 { 
-    Q_CHECK_PTR(parameters); 
-    return parameters->getConstrained(); 
+    return parameters.spinExchange; 
 }
 
 
 double Spinsystem::getRatio() const 
 { 
-    Q_CHECK_PTR(parameters); 
-    return parameters->getRatio(); 
+    return parameters.ratio; 
 }
 
 
 bool Spinsystem::getWavelengthPattern() const 
 { 
-    Q_CHECK_PTR(parameters); 
-    return parameters->getWavelengthPattern(); 
+    return parameters.wavelengthPattern; 
 }
 
 
 int Spinsystem::getWavelength() const 
 { 
-    Q_CHECK_PTR(parameters); 
-    return parameters->getWavelength(); 
+    return parameters.wavelength; 
 }
 
 
-void Spinsystem::setParameters(BaseParametersWidget* prms)
+void Spinsystem::setParameters(const SimulationParameters& prms)
 {
+    // the lattice keeps the size it was set up with, a new size takes effect in setup()
+
     qDebug() << __PRETTY_FUNCTION__;
 
-    Q_CHECK_PTR(prms);
     parameters = prms;
-    Q_CHECK_PTR(parameters);
 }
 
 
@@ -295,87 +481,44 @@ void Spinsystem::resetParameters()
     qDebug() << __PRETTY_FUNCTION__;
 
     computeHamiltonian();
-    isingDEBUG("spinsystem: " << "resetting parameters ... new initial H = " << Hamiltonian)
+    isingDEBUG("spinsystem: " << "resetting parameters ... new initial H = " << getHamiltonian())
 }
 
 
-void Spinsystem::setup()
+void Spinsystem::setup(enhance::Xoshiro256& source)
 {
-    // setup of the spinsystem: add all spins, add corresponding neighbours to each spin, set all spintypes randomly
+    // setup of the spinsystem: add all spins, add corresponding neighbours to each spin, set all spintypes randomly;
+    // the random numbers are split off source, threads setting up systems concurrently pass their own
 
     qDebug() << __PRETTY_FUNCTION__;
 
     spins.clear();
-    lastFlipped.clear();
+    packedSpins.clear();
+    packed = false;
 
     // some safety checks:
     if( getSpinExchange() )
     {
-        if( parameters->getWidth() % 2 != 0 )
+        if( parameters.width % 2 != 0 )
         {
-            parameters->setWidth(parameters->getWidth()+1);
+            parameters.width += 1;
             qInfo() << "Remember: system size must be an even number if system is constrained!";
         }
-        if( parameters->getHeight() % 2 != 0 )
+        if( parameters.height % 2 != 0 )
         {
-            parameters->setHeight(parameters->getHeight()+1);
+            parameters.height += 1;
             qInfo() << "Remember: system size must be an even number if system is constrained!";
         }
     }
 
-    auto width  = getWidth();
-    auto height = getHeight();
-    auto totalnumber = width * height;
-
-    // create spins:
-    for(unsigned int i=0; i<totalnumber; ++i)
-        spins.emplace_back(i, +1);
-
-    // set neighbours:
-    isingDEBUG("spinsystem: " << "system setup: setting neighbours for " << getWidth() << "*" << getHeight() << " system")
-    for(auto& s: spins)
-    {
-        std::vector<std::reference_wrapper<Spin> > Nrefs;
-        unsigned int Nid;
-        const unsigned int id = s.getID();
-
-        {
-            // up
-            Nid = ((long)id - static_cast<long>(width)) < 0 ? id - width + totalnumber : id - width;
-            assert( Nid < spins.size() );
-            if( Nid != id )
-                Nrefs.push_back( std::ref(spins[Nid]) );
-        }
-
-        {
-            // right
-            Nid = (id + 1) % width == 0  ? id + 1 - width : id + 1;
-            assert( Nid < spins.size() );
-            if( Nid != id )
-                Nrefs.push_back( std::ref(spins[Nid]) );
-        }
-
-        {
-            // below
-            Nid = id + width >= totalnumber ? id + width - totalnumber : id + width;
-            assert( Nid < spins.size() );
-            if( Nid != id )
-                 Nrefs.push_back( std::ref(spins[Nid]) );
-        }
-
-        {
-            // left
-            Nid = id % width == 0  ? id - 1 + width : id - 1;
-            assert( Nid < spins.size() );
-            if( Nid != id )
-                 Nrefs.push_back( std::ref(spins[Nid]) );
-        }
+    width  = parameters.width;
+    height = parameters.height;
 
-        s.setNeighbours(Nrefs);
-        std::stringstream tmp; 
-        std::for_each( std::begin(s.getNeighbours()), std::end(s.getNeighbours()), [&tmp](auto& N){ tmp << N.get().getID() <<  " "; } );
-        isingDEBUG("            " << "spin " << s.getID() << " has neighbours: " << tmp.str())
-    }
+    // create spins, neighbours follow from index arithmetic:
+    isingDEBUG("spinsystem: " << "system setup: creating dense " << width << "*" << height << " lattice")
+    spins.assign(width * height, Spin(+1));
+    engine = source.split();
+    releaseWorkspaces();
     
     // set spin types:
     if( getWavelengthPattern() )
@@ -396,13 +539,16 @@ void Spinsystem::resetSpins()
 
     qDebug() << __PRETTY_FUNCTION__;
 
+    // the types are set on the dense lattice
+    const bool wasPacked = packed;
+    setPacked(false);
+
     int random;
     if( ! getSpinExchange() ) // initialise spins randomly
     {
         for( auto& s: spins )
         {
-            random = enhance::randomInt(0,1);
-            s.setType( random == 1 ? +1 : -1 );
+            s.setType( engine() >> 63 ? +1 : -1 );
         }
     }      
     else  // constrained to specific up-spin to down-spin ratio
@@ -414,19 +560,18 @@ void Spinsystem::resetSpins()
         {
             do
             {
-                random = enhance::randomInt(0, spins.size()-1);
+                random = enhance::randomBounded(spins.size(), engine);
             }
             while( spins[random].getType() == -1 );
             spins[random].setType(-1);
         }
     }
 
-    // clear / reset all vectors: 
-    lastFlipped.clear();
+    setPacked(wasPacked);
     
     // calculate initial Hamiltonian:
     computeHamiltonian();
-    isingDEBUG("spinsystem: " << "resetting spins randomly... new initial H = " << Hamiltonian)
+    isingDEBUG("spinsystem: " << "resetting spins randomly... new initial H = " << getHamiltonian())
     isingDEBUG( getStringOfSystem() )
 
 }
@@ -438,6 +583,10 @@ void Spinsystem::resetSpinsCosinus(const double k)
 
     qDebug() << __PRETTY_FUNCTION__;
 
+    // the types are set on the dense lattice
+    const bool wasPacked = packed;
+    setPacked(false);
+
     int random;
     
     unsigned int totNrDownSpins = 0;
@@ -452,19 +601,18 @@ void Spinsystem::resetSpinsCosinus(const double k)
         {
             do
             {
-                random = enhance::randomInt(i*getWidth(), (i+1)*getWidth() - 1);
+                random = i*getWidth() + enhance::randomBounded(getWidth(), engine);
             }
             while( spins[random].getType() == -1 );
             spins[random].setType(-1);
         }
     }
 
-    // clear / reset all vectors: 
-    lastFlipped.clear();
+    setPacked(wasPacked);
     
     // calculate initial Hamiltonian:
     computeHamiltonian();
-    isingDEBUG("spinsystem: " << "resetting spins with cos(" << getWavelength() << "y ) pattern ... new initial H = " << Hamiltonian)
+    isingDEBUG("spinsystem: " << "resetting spins with cos(" << getWavelength() << "y ) pattern ... new initial H = " << getHamiltonian())
     isingDEBUG("spinsystem: " << "# of down spins: " << totNrDownSpins)
     isingDEBUG(getStringOfSystem())
 
@@ -475,10 +623,10 @@ void Spinsystem::print(std::ostream & stream) const
 {
     // print spins to stream
 
-    for( const auto& s: spins )
+    for( unsigned long id = 0; id < getSize(); ++id )
     {
-        stream << ( s.getType() == -1 ? "-" : "+" )
-        << ( (static_cast<unsigned int>(s.getID() + 1)) % getWidth() == 0 ? "\n        " : " " );
+        stream << ( getSpinType(id) == -1 ? "-" : "+" )
+        << ( (id + 1) % width == 0 ? "\n        " : " " );
     }
 }
 
@@ -496,85 +644,27 @@ std::string Spinsystem::getStringOfSystem() const
 
 
 
-Histogram<double> Spinsystem::computeCorrelation() const
+std::vector<double> Spinsystem::getSpinTypes() const
 {
-    // compute correlation between spins: G(r) = <S(0)S(r)> - <S>^2
+    // copy of the configuration as +-1, row by row
 
-    double binWidth = 0.1;
-    Histogram<double> correlation {binWidth};
-    Histogram<double> counter {binWidth};
-    isingDEBUG("spinsystem: " << "computing correlation <Si Sj>")
-
-    // first: <S(0)S(r)>:
-    double maxDist = ( getWidth() >= getHeight() ? (double) getWidth() : (double) getHeight() )/2  + binWidth/2;
-    for( auto& s1 : spins )
+    const auto lock = lockStorage();
+    std::vector<double> types(getSize());
+    for( unsigned long id = 0; id < getSize(); ++id )
     {
-        for( auto& s2 : spins )
-        {
-            if( s1.getID() != s2.getID() )
-            {
-                double dist = distance( s1,  s2);
-                if( dist < maxDist )
-                {
-                    correlation.add_data( dist, s1.getType() == s2.getType() ? 1 : -1);
-                    counter.add_data( dist );
-                    isingDEBUG("            " << "correlating " << s1.getID() << " with " << s2.getID() <<" : " << (s1.getType() == s2.getType() ? 1 : -1) << "   distance " << dist)
-                }
-            }
-        }
+        types[id] = getSpinType(id);
     }
-    // normalisation:
-    std::for_each(std::begin(correlation), std::end(correlation), [&](auto& B)
-    { 
-        B.counter /= counter.get_data(B.position()); 
-    });
-
-    // then:  - <S>^2:
-    correlation.shift( getMagnetisation()*getMagnetisation() );
-
-    correlation.sort_bins();
-    return correlation;
+    return types;
 }
 
 
-Histogram<double> Spinsystem::computeStructureFunction(Histogram<double> correlation) const
+StructureFactor Spinsystem::computeStructureFactor() const
 {
-    // compute Fourier transformation S(k) = integral cos(2PI/width*k*r) G(r) dr, with r = distance between spins
-
-    isingDEBUG("spinsystem: " << "computing structure function S(k)")
-
-    // computation of delta r's:
-    Histogram<double> deltaR {correlation};
-    double previous = 0;
-    double next = 0;
-    auto it = std::begin(deltaR);
-    for( ; it != std::end(deltaR) - 1; it ++)
-    {
-        double current = it->position();
-        it ++;
-        next = it->position();
-        it --;
-        double left = (current - previous)/2 + previous;
-        double right = (next - current)/2 + current;
-        it->counter = right - left;
-        previous = current;
-    }
-    it->counter = it->position() - previous;
+    // S(kx, ky) of the current configuration, the correlation G(r) and the radial S(k) are computed from it
 
-    // computation of structure factor:
-    Histogram<double> structureFunction {0.5};
-    double k = 0;
-    while( k < getWidth()/2 )
-    {
-        structureFunction.add_data(k, 0.5);     // includes intitial point for r=0 where cos(k*0)*corr(0)*deltar = 0.5 because corr(0)=1 and deltar = 0.5
-        for(auto& B: correlation)
-        {
-            structureFunction.add_data(k, std::cos( k*B.position()*2*M_PI/getWidth() ) * B.counter * deltaR.get_data(B.position()) );
-        }
-        k += 0.5;
-    }
+    isingDEBUG("spinsystem: " << "computing structure factor S(kx, ky)")
 
-    return structureFunction;
+    return StructureFactor(getSpinTypes(), getWidth(), getHeight());
 }
 
 
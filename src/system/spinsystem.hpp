@@ -1,36 +1,134 @@
 #pragma once
 
 #include "spin.hpp"
+#include "packed_lattice.hpp"
 #include "lib/enhance.hpp"
+#include "lib/thread_pool.hpp"
 #include "definitions.hpp"
 #include "histogram.hpp"
-#include "gui/parameters/base_parameters_widget.hpp"
+#include "structure_factor.hpp"
+#include "simulation_parameters.hpp"
 #include <ostream>
 #include <string>
 #include <sstream>
 #include <cassert>
+#include <array>
+#include <numeric>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <utility>
+
+
+
+// a move proposed by Spinsystem::propose(): the spins it would flip and the change it would cause,
+// nothing is written to the lattice before Spinsystem::commit()
+struct Move
+{
+    static constexpr unsigned long none = static_cast<unsigned long>(-1);
+
+    unsigned long spin    {none};       // flipped spin, none if there is nothing to do
+    unsigned long partner {none};       // neighbour exchanged with spin in spin-exchange mode, else none
+    EnergyChange  change {};
+    double        proposalRatio {1};    // q(reverse)/q(move): proposal probability of the reverse move over that of the move
+};
 
 
 
 class Spinsystem
 {
 private:
-    double Hamiltonian {0};
-    std::vector<Spin> spins {};
-    
-    // Fuer Aufgabe 1.4:
-    std::vector<unsigned int> lastFlipped {};   // contains spin-ID's of flipped Spins from last call to flip()
+    // exact integer bookkeeping of the energy, H = -J * bondSum - B * spinSum is formed on request
+    std::int64_t bondSum {0};                   // sum_<ij> s_i*s_j
+    std::int64_t spinSum {0};                   // sum_i s_i
+    std::vector<Spin> spins {};                 // dense lattice, spin-ID = row * width + column
+    PackedLattice     packedSpins {};           // bit-packed lattice, replaces spins while packed
+    bool              packed {false};
+
+    // held while the storage is switched, readers on other threads than the simulation hold it while reading
+    mutable std::mutex storageMutex {};
+
+    // random numbers of propose(), seeded in setup() so that systems can be updated concurrently
+    enhance::Xoshiro256 engine {};
+
+    // lattice dimensions the spins vector was built for in setup()
+    unsigned long width  {0};
+    unsigned long height {0};
+
+    // spin-exchange mode: indexable set of antiparallel bonds, bond-ID = 2 * spin-ID + (0: right, 1: below)
+    static constexpr unsigned long noBond = static_cast<unsigned long>(-1);
+    std::vector<unsigned long> interfaceBonds {};       // antiparallel bond-IDs in arbitrary order
+    std::vector<unsigned long> interfacePosition {};    // position of every bond-ID in interfaceBonds or noBond
+
+    // n-fold way: spins grouped into classes of equal flip rate by their type and sumNeighbours,
+    // class = (type + 1) / 2 * 9 + sumNeighbours + 4; only kept up to date by nFoldWay() itself
+    static constexpr unsigned int nFoldClasses = 18;
+    std::array<std::vector<unsigned long>, nFoldClasses> classMembers {};
+    std::vector<unsigned long> classPosition {};    // position of every spin-ID in its class
+    std::vector<std::uint8_t>  classOf {};          // class of every spin-ID
+    bool                       classesValid {false};
+
+    inline unsigned int spinClass(const unsigned long) const;
+    void   computeClasses();
+    void   updateClass(const unsigned long);
+
+    // Wolff cluster workspace, allocated by the first cluster update and reused between calls:
+    std::vector<unsigned long> cluster {};      // members of the growing cluster, doubles as queue
+    std::vector<std::uint64_t> inCluster {};    // visited bitmap, one bit per spin-ID
+
+    // Swendsen-Wang workspace, allocated by the first cluster update and reused between calls:
+    std::vector<unsigned long> clusterParent {};    // union-find forest, the last entry is the ghost spin
+    std::vector<unsigned long> clusterRoot {};      // root of every spin after labelling
+    std::vector<std::uint8_t>  clusterFlip {};      // flip decision, valid at the roots only
+    std::vector<std::vector<std::pair<unsigned long, unsigned long>>> boundaryBonds {};   // bonds leaving a row block
+
+    void   allocateClusterWorkspace();
+    void   releaseWorkspaces();
+
+    inline unsigned long findRoot(unsigned long);
+    inline void          unite(const unsigned long, const unsigned long);
 
     void   computeHamiltonian();
-    double localEnergyInteraction(const Spin&) const;
-    double localEnergyMagnetic(const Spin&) const;
+    void   computeInterface();
+    void   updateInterface(const unsigned long, const unsigned long);
+    void   updateInterfaceAround(const unsigned long);
+
+    inline std::array<unsigned long,4> neighbours(const unsigned long) const;
+    int           sumNeighbours(const unsigned long) const;
+    inline unsigned long bondPartner(const unsigned long) const;
+    int           exchangeBonds(const unsigned long, const unsigned long) const;
+
+    template<typename ACCEPTANCE>
+    EnergyChange updateSublattice(const unsigned short, const unsigned long, const unsigned long, ACCEPTANCE&&);
 
 public:
-    void flip();
-    void flip_back();
+    Move propose();
+    void commit(const Move&);
+
+    template<typename ACCEPTANCE>
+    void checkerboardSweep(enhance::ThreadPool&, ACCEPTANCE&&);
+    void checkerboardSweep(enhance::ThreadPool&, const AcceptanceTable&, std::vector<enhance::Xoshiro256x4>&);
+
+    template<typename ENGINE>
+    unsigned long wolffUpdate(const std::uint64_t, const std::uint64_t, ENGINE&);
+
+    template<typename ENGINE>
+    void swendsenWangSweep(enhance::ThreadPool&, const std::uint64_t, const std::uint64_t, std::vector<ENGINE>&);
+
+    template<typename RATE, typename ENGINE>
+    unsigned long nFoldWay(const double, RATE&&, ENGINE&);
+
+    bool   setPacked(const bool);
+    bool   isPacked() const { return packed; }
+    std::unique_lock<std::mutex> lockStorage() const { return std::unique_lock<std::mutex>(storageMutex); }
+    inline int getSpinType(const unsigned long) const;
+    unsigned long getSize() const { return width * height; }
 
     double getMagnetisation() const;
-    auto   getHamiltonian() const { return Hamiltonian; }
+    double getHamiltonian() const;
+    auto   getBondSum() const { return bondSum; }
+    auto   getSpinSum() const { return spinSum; }
+    std::int64_t countSpins() const;           // spin sum counted from the lattice, O(N)
 
 
 /* 
@@ -54,8 +152,8 @@ public:
  * DIE IMPLEMENTIERUNGSAUFGABEN UND KANN IGNORIERT WERDEN 
  */ 
 private:
-    BaseParametersWidget* parameters = Q_NULLPTR;
-    double distance(const Spin&, const Spin&) const;
+    SimulationParameters parameters {};
+    double distance(const unsigned long, const unsigned long) const;
 
 public:
     Spinsystem()  {};
@@ -63,20 +161,20 @@ public:
     Spinsystem(const Spinsystem&) = delete;
     void operator=(const Spinsystem&) = delete;
 
-    inline const auto& getSpins() const { return spins; };
+    inline const auto& getSpins() const { assert( ! packed ); return spins; };
 
     double        getRatio() const;              
     bool          getWavelengthPattern() const; 
     int           getWavelength() const;   
 
-    void setParameters(BaseParametersWidget*);
-    void setup();
+    void setParameters(const SimulationParameters&);
+    void setup(enhance::Xoshiro256& source = enhance::rand_engine);
     void resetParameters();
     void resetSpins();
     void resetSpinsCosinus(const double);
 
-    Histogram<double> computeCorrelation() const;
-    Histogram<double> computeStructureFunction(const Histogram<double>) const;
+    std::vector<double> getSpinTypes() const;
+    StructureFactor computeStructureFactor() const;
     // void computeSystemTimesCos() const;
 
     void print(std::ostream & ) const;
@@ -85,3 +183,385 @@ public:
 
 
 
+inline std::array<unsigned long,4> Spinsystem::neighbours(const unsigned long id) const
+{
+    // neighbours on the periodic lattice by index arithmetic: up, right, below, left
+    // (a spin is its own neighbour only if width or height is 1)
+
+    const unsigned long total  = width * height;
+    const unsigned long column = id % width;
+
+    return {{ id >= width ? id - width : id - width + total,
+              column + 1 == width ? id + 1 - width : id + 1,
+              id + width < total ? id + width : id + width - total,
+              column == 0 ? id - 1 + width : id - 1 }};
+}
+
+
+
+
+inline int Spinsystem::getSpinType(const unsigned long id) const
+{
+    // type of spin id in either storage
+    return packed ? packedSpins.getType(id) : spins[id].getType();
+}
+
+
+
+inline unsigned int Spinsystem::spinClass(const unsigned long id) const
+{
+    return (spins[id].getType() + 1) / 2 * 9 + sumNeighbours(id) + 4;
+}
+
+
+
+inline unsigned long Spinsystem::findRoot(unsigned long id)
+{
+    // root of the cluster containing id, with path halving
+    while( clusterParent[id] != id )
+    {
+        clusterParent[id] = clusterParent[clusterParent[id]];
+        id = clusterParent[id];
+    }
+    return id;
+}
+
+
+
+inline void Spinsystem::unite(const unsigned long a, const unsigned long b)
+{
+    // merge the clusters of a and b, the smaller root index becomes the new root
+    const unsigned long rootA = findRoot(a);
+    const unsigned long rootB = findRoot(b);
+    if( rootA < rootB ) clusterParent[rootB] = rootA;
+    else                clusterParent[rootA] = rootB;
+}
+
+
+
+
+inline unsigned long Spinsystem::bondPartner(const unsigned long bond) const
+{
+    // second spin of a bond: right neighbour or neighbour below of spin bond / 2
+    return neighbours(bond / 2)[bond % 2 == 0 ? 1 : 2];
+}
+
+
+
+template<typename ACCEPTANCE>
+void Spinsystem::checkerboardSweep(enhance::ThreadPool& pool, ACCEPTANCE&& accept)
+{
+    // one sweep in spin-flip mode: every spin is offered one Metropolis flip.
+    // The lattice is split into the sublattices colour = (row + column) % 2. Spins of one colour
+    // only have neighbours of the other colour, so all updates within a half-sweep are independent
+    // of each other and can be done in parallel by blocks of rows; each of them fulfils detailed balance.
+    // accept(change, block) decides about a move, block is in [0, pool.size()).
+    // An odd height couples the first and the last row across the boundary, then a single block is used.
+
+    assert( ! packed );
+    const unsigned long blocks = height % 2 == 0 ? std::min<unsigned long>(pool.size(), height) : 1;
+    std::vector<EnergyChange> changes (blocks);
+    classesValid = false;
+
+    for( unsigned short colour = 0; colour < 2; ++colour )
+    {
+        pool.parallel_for(blocks, [&](const std::size_t block, const unsigned int)
+        {
+            const unsigned long firstRow = block * height / blocks, lastRow = (block + 1) * height / blocks;
+            auto blockAccept = [&](const EnergyChange& change){ return accept(change, block); };
+            changes[block] = updateSublattice(colour, firstRow, lastRow, blockAccept);
+        });
+
+        // reduce energy change of this half-sweep
+        for( const auto& C : changes )
+        {
+            bondSum += C.bonds;
+            spinSum += C.spins;
+        }
+    }
+}
+
+
+
+template<typename ACCEPTANCE>
+EnergyChange Spinsystem::updateSublattice(const unsigned short colour, const unsigned long firstRow, const unsigned long lastRow, ACCEPTANCE&& accept)
+{
+    // Metropolis update of all spins of one colour in rows [firstRow, lastRow), returns the summed change
+
+    EnergyChange total {};
+    for( unsigned long row = firstRow; row < lastRow; ++row )
+    {
+        for( unsigned long column = (row + colour) % 2; column < width; column += 2 )
+        {
+            const unsigned long id = row * width + column;
+            const EnergyChange change { -2 * sumNeighbours(id), -2 * spins[id].getType() };
+            if( accept(change) )
+            {
+                spins[id].flip();
+                total.bonds += change.bonds;
+                total.spins += change.spins;
+            }
+        }
+    }
+    return total;
+}
+
+
+
+template<typename ENGINE>
+unsigned long Spinsystem::wolffUpdate(const std::uint64_t bondThreshold, const std::uint64_t ghostThreshold, ENGINE& engine)
+{
+    // Wolff single-cluster update in spin-flip mode, returns the number of spins the cluster has visited.
+    // Starting from a random seed, neighbours with J*s_i*s_j > 0 join with probability 1 - exp(-2|J|/T)
+    // (bondThreshold, scaled to 2^64). The field B is treated as a ghost spin aligned with B that every
+    // spin with B*s_i > 0 is bonded to with probability 1 - exp(-2|B|/T) (ghostThreshold). A cluster
+    // bonded to the ghost is not flipped, so growing can stop as soon as that happens.
+    // engine() has to deliver uniformly distributed 64 bit numbers.
+
+    assert( ! getSpinExchange() );
+    assert( ! packed );
+    if( inCluster.size() * 64 < spins.size() ) allocateClusterWorkspace();
+
+    const double J = getInteraction();
+    const double B = getMagnetic();
+    const int    signJ = (J > 0) - (J < 0);
+    const int    signB = (B > 0) - (B < 0);
+
+    auto visited = [&](const unsigned long id){ return (inCluster[id / 64] >> (id % 64)) & 1u; };
+    auto visit   = [&](const unsigned long id){ inCluster[id / 64] |= std::uint64_t{1} << (id % 64); cluster.push_back(id); };
+
+    cluster.clear();
+    visit( enhance::randomBounded(spins.size(), engine) );
+
+    bool ghost = false;
+    for( unsigned long k = 0; k < cluster.size(); ++k )
+    {
+        const unsigned long id = cluster[k];
+        const int           S  = spins[id].getType();
+
+        if( S * signB > 0 && engine() < ghostThreshold )
+        {
+            ghost = true;
+            break;
+        }
+        for( const auto N : neighbours(id) )
+        {
+            if( N != id && ! visited(N) && signJ * S * spins[N].getType() > 0 && engine() < bondThreshold )
+            {
+                visit(N);
+            }
+        }
+    }
+
+    // bonds to spins outside the cluster change sign, bonds inside do not
+    EnergyChange change {};
+    if( ! ghost )
+    {
+        for( const auto id : cluster )
+        {
+            const int S = spins[id].getType();
+            for( const auto N : neighbours(id) )
+            {
+                if( N != id && ! visited(N) ) change.bonds -= 2 * S * spins[N].getType();
+            }
+            change.spins -= 2 * S;
+        }
+        for( const auto id : cluster ) spins[id].flip();
+        classesValid = false;
+        bondSum += change.bonds;
+        spinSum += change.spins;
+    }
+    isingDEBUG("spinsystem: " << "wolff cluster of " << cluster.size() << " spins " << (ghost ? "bonded to the ghost spin, not flipped" : "flipped"))
+
+    // only the bits of this cluster were set
+    for( const auto id : cluster ) inCluster[id / 64] = 0;
+    return cluster.size();
+}
+
+
+
+template<typename ENGINE>
+void Spinsystem::swendsenWangSweep(enhance::ThreadPool& pool, const std::uint64_t bondThreshold, const std::uint64_t ghostThreshold, std::vector<ENGINE>& engines)
+{
+    // Swendsen-Wang update in spin-flip mode: every bond with J*s_i*s_j > 0 is activated with probability
+    // 1 - exp(-2|J|/T), every spin with B*s_i > 0 is bonded to a ghost spin with probability 1 - exp(-2|B|/T),
+    // then every cluster not bonded to the ghost is flipped with probability 1/2.
+    // The lattice is split into blocks of rows, block b draws from engines[b]. Each block labels its own
+    // clusters with a union-find forest that is only linked within the block; bonds leaving the block and
+    // one link per block to the ghost spin are collected and merged serially afterwards.
+    // The smaller index always becomes the root, so the ghost (index N) never is one unless it is alone.
+
+    assert( ! getSpinExchange() );
+    assert( ! packed );
+    if( clusterParent.size() != spins.size() + 1 ) allocateClusterWorkspace();
+
+    const unsigned long total  = spins.size();
+    const unsigned long ghost  = total;
+    const unsigned long blocks = std::min<unsigned long>({ pool.size(), height, engines.size() });
+    const int signJ = (getInteraction() > 0) - (getInteraction() < 0);
+    const int signB = (getMagnetic() > 0) - (getMagnetic() < 0);
+
+    if( boundaryBonds.size() != blocks ) boundaryBonds.assign(blocks, {});
+    classesValid = false;
+    std::vector<EnergyChange> changes (blocks);
+
+    // activate bonds and label clusters within every block
+    pool.parallel_for(blocks, [&](const std::size_t block, const unsigned int)
+    {
+        const unsigned long first = block * height / blocks * width;
+        const unsigned long last  = (block + 1) * height / blocks * width;
+        auto& engine   = engines[block];
+        auto& boundary = boundaryBonds[block];
+        boundary.clear();
+
+        for( unsigned long id = first; id < last; ++id ) clusterParent[id] = id;
+
+        unsigned long ghostLink = ghost;        // first spin of this block bonded to the ghost
+        for( unsigned long id = first; id < last; ++id )
+        {
+            const int  S  = spins[id].getType();
+            const auto Nb = neighbours(id);
+
+            // right neighbour lies in the same row, the one below may lie in the next block
+            if( signJ * S * spins[Nb[1]].getType() > 0 && engine() < bondThreshold ) unite(id, Nb[1]);
+            if( signJ * S * spins[Nb[2]].getType() > 0 && engine() < bondThreshold )
+            {
+                if( Nb[2] >= first && Nb[2] < last ) unite(id, Nb[2]);
+                else                                 boundary.emplace_back(id, Nb[2]);
+            }
+            if( S * signB > 0 && engine() < ghostThreshold )
+            {
+                if( ghostLink == ghost ) ghostLink = id;
+                else                     unite(id, ghostLink);
+            }
+        }
+        if( ghostLink != ghost ) boundary.emplace_back(ghostLink, ghost);
+    });
+
+    // merge the clusters across the block boundaries
+    clusterParent[ghost] = ghost;
+    for( const auto& boundary : boundaryBonds )
+    {
+        for( const auto& bond : boundary ) unite(bond.first, bond.second);
+    }
+    const unsigned long ghostRoot = findRoot(ghost);
+
+    // resolve roots (read-only on the forest now) and draw a flip decision at every root
+    pool.parallel_for(blocks, [&](const std::size_t block, const unsigned int)
+    {
+        const unsigned long first = block * height / blocks * width;
+        const unsigned long last  = (block + 1) * height / blocks * width;
+        auto& engine = engines[block];
+
+        for( unsigned long id = first; id < last; ++id )
+        {
+            unsigned long root = id;
+            while( clusterParent[root] != root ) root = clusterParent[root];
+            clusterRoot[id] = root;
+            if( root == id ) clusterFlip[id] = root != ghostRoot && (engine() >> 63);
+        }
+    });
+
+    // energy change: bonds between a flipped and a not flipped spin change sign
+    pool.parallel_for(blocks, [&](const std::size_t block, const unsigned int)
+    {
+        const unsigned long first = block * height / blocks * width;
+        const unsigned long last  = (block + 1) * height / blocks * width;
+        EnergyChange change {};
+
+        for( unsigned long id = first; id < last; ++id )
+        {
+            const int  S     = spins[id].getType();
+            const bool flips = clusterFlip[clusterRoot[id]];
+            const auto Nb    = neighbours(id);
+            for( const auto N : { Nb[1], Nb[2] } )
+            {
+                if( flips != static_cast<bool>(clusterFlip[clusterRoot[N]]) ) change.bonds -= 2 * S * spins[N].getType();
+            }
+            if( flips ) change.spins -= 2 * S;
+        }
+        changes[block] = change;
+    });
+
+    // flip
+    pool.parallel_for(blocks, [&](const std::size_t block, const unsigned int)
+    {
+        const unsigned long first = block * height / blocks * width;
+        const unsigned long last  = (block + 1) * height / blocks * width;
+        for( unsigned long id = first; id < last; ++id )
+        {
+            if( clusterFlip[clusterRoot[id]] ) spins[id].flip();
+        }
+    });
+
+    for( const auto& C : changes )
+    {
+        bondSum += C.bonds;
+        spinSum += C.spins;
+    }
+}
+
+
+
+template<typename RATE, typename ENGINE>
+unsigned long Spinsystem::nFoldWay(const double time, RATE&& rate, ENGINE& engine)
+{
+    // rejection-free continuous time Monte Carlo (n-fold way) in spin-flip mode, returns the number of flips.
+    // rate(dBonds, dSpins) is the Metropolis probability of a single flip; every spin of a class flips with the
+    // same rate, so with n_c spins in class c the total rate is R = sum_c n_c * rate_c. Each event picks a class
+    // with probability n_c * rate_c / R, flips a uniformly chosen member and advances the clock by an exponential
+    // waiting time of mean N / R, measured in single-spin Metropolis steps.
+    // The events are done until the given time has passed. The configuration left is the one the system has at
+    // that time, so samples taken after every call are equally spaced in time and thus correctly time-weighted.
+    // Waiting times are memoryless, the one cut off at the end does not have to be carried over.
+
+    assert( ! getSpinExchange() && ! packed );
+    if( ! classesValid ) computeClasses();
+
+    std::array<double, nFoldClasses> rates {};
+    for( unsigned int c = 0; c < nFoldClasses; ++c )
+    {
+        const int type = c < 9 ? -1 : 1;
+        const int sum  = static_cast<int>(c % 9) - 4;
+        rates[c] = rate(-2 * sum, -2 * type);
+    }
+
+    auto uniform = [&](){ return std::ldexp(static_cast<double>((engine() >> 11) + 1), -53); };    // in (0,1]
+
+    const double spinCount = spins.size();
+    double clock = 0;
+    unsigned long events = 0;
+    while( true )
+    {
+        double total = 0;
+        for( unsigned int c = 0; c < nFoldClasses; ++c ) total += classMembers[c].size() * rates[c];
+        if( total <= 0 ) break;
+
+        clock += -std::log(uniform()) * spinCount / total;
+        if( clock > time ) break;
+
+        // choose class and spin
+        double choice = uniform() * total;
+        unsigned int c = 0;
+        for( unsigned int k = 0; k < nFoldClasses; ++k )
+        {
+            const double weight = classMembers[k].size() * rates[k];
+            if( weight <= 0 ) continue;
+            c = k;                  // the last populated class if rounding leaves choice > 0
+            if( choice <= weight ) break;
+            choice -= weight;
+        }
+        const auto& members = classMembers[c];
+        const unsigned long id = members[ enhance::randomBounded(members.size(), engine) ];
+
+        // flip and reclassify the spin and its neighbours
+        bondSum -= 2 * sumNeighbours(id);
+        spinSum -= 2 * spins[id].getType();
+        spins[id].flip();
+        updateClass(id);
+        for( const auto N : neighbours(id) ) updateClass(N);
+        ++events;
+    }
+    isingDEBUG("spinsystem: " << "n-fold way: " << events << " flips in time " << time)
+    return events;
+}
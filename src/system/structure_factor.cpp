@@ -0,0 +1,133 @@
+#include "structure_factor.hpp"
+#include "lib/fft.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+
+
+
+StructureFactor::StructureFactor(const std::vector<double>& spins, const unsigned long _width, const unsigned long _height)
+  : width(_width),
+    height(_height)
+{
+    assert( spins.size() == width * height && ! spins.empty() );
+
+    const double N = spins.size();
+    magnetisation = std::accumulate(std::begin(spins), std::end(spins), 0.0) / N;
+
+    const auto spectrum = enhance::realFFT2D(spins, width, height);
+    power.reserve(spectrum.size());
+    for( const auto& F : spectrum )
+    {
+        power.push_back( std::norm(F) / N );
+    }
+    // the k = 0 mode is N <S>^2 exactly, without it the spectrum belongs to s - <S>
+    power[0] = 0;
+}
+
+
+
+Histogram<double> StructureFactor::computeCorrelation(const double binWidth) const
+{
+    // G(d) = 1/N sum_k S(k) exp(i k d). S(k) is real and even, so this is the forward transform of S over the
+    // full k plane. Then G is summed per squared distance dx^2 + dy^2 of minimum images up to half the lattice
+    // size, the shells are then averaged over bins of binWidth centred on multiples of binWidth, d = 0 is left out
+
+    const unsigned long half = width/2 + 1;
+    std::vector<double> fullPower(width * height);
+    for( unsigned long ky = 0; ky < height; ++ky )
+    {
+        for( unsigned long kx = 0; kx < width; ++kx )
+        {
+            fullPower[ky*width + kx] = kx < half ? (*this)(kx, ky) : (*this)(width - kx, (height - ky) % height);
+        }
+    }
+    const auto transform = enhance::realFFT2D(fullPower, width, height);
+
+    const double N = width * height;
+    const unsigned long maxX = width / 2;
+    const unsigned long maxY = height / 2;
+    std::vector<double> sums(maxX*maxX + maxY*maxY + 1, 0);
+    std::vector<double> counts(sums.size(), 0);
+    for( unsigned long dy = 0; dy < height; ++dy )
+    {
+        const unsigned long y = std::min(dy, height - dy);
+        for( unsigned long dx = 0; dx < half; ++dx )
+        {
+            const unsigned long squared = dx*dx + y*y;
+            sums[squared] += weight(dx) * transform[dy*half + dx].real() / N;
+            counts[squared] += weight(dx);
+        }
+    }
+
+    Histogram<double> correlation {0, std::max(width, height) / 2.0, binWidth};
+    Histogram<double> weights {0, std::max(width, height) / 2.0, binWidth};
+    for( unsigned long squared = 1; squared < sums.size(); ++squared )
+    {
+        if( counts[squared] == 0 ) continue;
+        const double distance = std::sqrt(static_cast<double>(squared));
+        correlation.add_data(distance, sums[squared]);
+        weights.add_data(distance, counts[squared]);
+    }
+    auto W = std::begin(weights);
+    for( auto& B : correlation )
+    {
+        if( B.entries > 0 ) B.counter /= W->counter;
+        ++W;
+    }
+
+    return correlation;
+}
+
+
+
+Histogram<double> StructureFactor::computeStructureFunction(const double binWidth) const
+{
+    // S(k) averaged over the modes with |k| closest to a multiple of binWidth, for |k| < width/2 in units of
+    // 2 pi / width; ky is rescaled to these units on rectangular lattices
+
+    const unsigned long shells = static_cast<unsigned long>( std::ceil(width / 2.0 / binWidth) );
+    Histogram<double> structureFunction {0, (shells - 1) * binWidth, binWidth};
+    Histogram<double> weights {0, (shells - 1) * binWidth, binWidth};
+    const double scale = static_cast<double>(width) / height;
+    for( unsigned long ky = 0; ky < height; ++ky )
+    {
+        const double y = std::min(ky, height - ky) * scale;
+        for( unsigned long kx = 0; kx <= width/2; ++kx )
+        {
+            const double k = std::sqrt(kx*kx + y*y);
+            structureFunction.add_data(k, weight(kx) * (*this)(kx, ky));
+            weights.add_data(k, weight(kx));
+        }
+    }
+    auto W = std::begin(weights);
+    for( auto& B : structureFunction )
+    {
+        if( B.entries > 0 ) B.counter /= W->counter;
+        ++W;
+    }
+    return structureFunction;
+}
+
+
+
+void StructureFactor::print(std::ostream& STREAM) const
+{
+    // the stored half plane "kx ky S", kx and ky in units of 2 pi / width and 2 pi / height,
+    // ky from -height/2 on and a blank line after every kx for splot
+
+    for( unsigned long kx = 0; kx <= width/2; ++kx )
+    {
+        for( unsigned long i = 0; i < height; ++i )
+        {
+            const long ky = static_cast<long>(i) - static_cast<long>(height/2);
+            STREAM << std::setw(8) << kx
+                   << std::setw(8) << ky
+                   << std::setw(20) << std::setprecision(6) << (*this)(kx, (ky + height) % height)
+                   << '\n';
+        }
+        STREAM << '\n';
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "histogram.hpp"
+#include <ostream>
+#include <vector>
+
+
+
+// Structure factor S(kx, ky) = |sum_r (s(r) - <s>) exp(-i k r)|^2 / N of one spin configuration, from a
+// real-to-complex 2D FFT in O(N log N). By Wiener-Khinchin its inverse transform is the correlation
+// G(d) = <S(0)S(d)> - <S>^2 for every displacement d, which is averaged over shells of equal distance |d|.
+// The radially averaged S(k) is read off the same spectrum, k in units of 2 pi / width.
+// Since the field is symmetric under k -> -k, only kx = 0 ... width/2 is stored.
+class StructureFactor
+{
+public:
+    StructureFactor(const std::vector<double>&, const unsigned long, const unsigned long);
+
+    unsigned long getWidth() const { return width; }
+    unsigned long getHeight() const { return height; }
+    double getMagnetisation() const { return magnetisation; }
+
+    // kx = 0 ... width/2, ky = 0 ... height-1
+    double operator()(const unsigned long kx, const unsigned long ky) const { return power[ky*(width/2 + 1) + kx]; }
+
+    Histogram<double> computeCorrelation(const double binWidth = 0.1) const;
+    Histogram<double> computeStructureFunction(const double binWidth = 0.5) const;
+
+    void print(std::ostream&) const;
+
+private:
+    // modes of the stored half plane count twice unless they are their own mirror image
+    double weight(const unsigned long kx) const { return kx == 0 || 2*kx == width ? 1 : 2; }
+
+    unsigned long       width;
+    unsigned long       height;
+    double              magnetisation {0};
+    std::vector<double> power {};
+};
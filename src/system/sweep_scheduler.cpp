@@ -0,0 +1,481 @@
+#include "sweep_scheduler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <numeric>
+#include <iomanip>
+#include <sstream>
+
+
+
+namespace
+{
+    const char* parameterName(const SWEEPPARAMETER parameter)
+    {
+        switch( parameter )
+        {
+            case SWEEPPARAMETER::Interaction :  return "J";
+            case SWEEPPARAMETER::Magnetic :     return "B";
+            default :                           return "T";
+        }
+    }
+
+
+    void setParameter(SimulationParameters& P, const SWEEPPARAMETER parameter, const double value)
+    {
+        switch( parameter )
+        {
+            case SWEEPPARAMETER::Temperature :  P.temperature = value; break;
+            case SWEEPPARAMETER::Interaction :  P.interaction = value; break;
+            case SWEEPPARAMETER::Magnetic :     P.magnetic = value; break;
+        }
+    }
+}
+
+
+
+void SweepScheduler::run()
+{
+    // all points of the sweep, returns when they are done or stop() has been called
+
+    qDebug() << __PRETTY_FUNCTION__;
+    Q_CHECK_PTR(pool);
+
+    running.store(true);
+    pointsDone.store(0);
+    stepsSaved.store(0);
+    {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        rows.assign(getPoints(), std::string());
+        averages.assign(getPoints(), Averages());
+        equilibrationSteps.assign(getPoints(), 0);
+        finished.assign(getPoints(), false);
+        nextRow = 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(statusMutex);
+        status.assign(pool->size(), WorkerStatus());
+    }
+
+    // the most expensive chains first, so that none of them is left over for the end of the sweep
+    std::vector<double> costs;
+    for( const auto& chain : chains )
+    {
+        costs.push_back( std::accumulate(std::begin(chain), std::end(chain), 0.0, [this](auto sum, auto i){ return sum + cost(i); }) );
+    }
+    std::vector<std::size_t> order(chains.size());
+    std::iota(std::begin(order), std::end(order), 0);
+    std::stable_sort(std::begin(order), std::end(order), [&](auto lhs, auto rhs){ return costs[lhs] > costs[rhs]; });
+
+    std::vector<enhance::WorkStealingPool::Task> tasks;
+    for( const auto c : order )
+    {
+        tasks.emplace_back( [this, c](const unsigned int worker){ runChain(c, worker); } );
+    }
+    pool->run(std::move(tasks));
+
+    running.store(false);
+    {
+        // after a stop the finished points behind an unfinished one are still waiting
+        std::lock_guard<std::mutex> lock(outputMutex);
+        writeRows(true);
+    }
+    isingLOG("sweep: " << pointsDone.load() << " of " << getPoints() << " points done")
+    if( warmStart )
+    {
+        print_equilibration();
+        isingLOG("sweep: " << stepsSaved.load() << " of " << pointsDone.load() * parameters.stepsEquil << " equilibration steps saved by warm starts")
+    }
+}
+
+
+
+void SweepScheduler::stop()
+{
+    // from any thread: running points return after their current portion of steps and are left out, run() then
+    // writes the rows of all finished points
+    running.store(false);
+}
+
+
+
+std::vector<SweepScheduler::WorkerStatus> SweepScheduler::getStatus() const
+{
+    std::lock_guard<std::mutex> lock(statusMutex);
+    return status;
+}
+
+
+
+void SweepScheduler::makeChains()
+{
+    // without warm start every point is a chain of its own. Otherwise the path through all points (a grid is
+    // walked along a serpentine, a line is a single row) is cut into chainsPerWorker chains of about the same
+    // length per worker: the work-stealing pool can rebalance them, and since run() starts the most expensive
+    // chains first, those close to the peak do not wait behind the cheap ones
+
+    chains.clear();
+    const std::size_t N = getPoints();
+    if( ! warmStart )
+    {
+        for( std::size_t i = 0; i < N; ++i ) chains.emplace_back(1, i);
+        return;
+    }
+
+    const std::size_t rowSize = values.size();
+    std::vector<std::size_t> path;
+    for( std::size_t r = 0; r < rowValues.size(); ++r )
+    {
+        for( std::size_t j = 0; j < rowSize; ++j )
+        {
+            path.push_back( r*rowSize + (r % 2 == 0 ? j : rowSize-1 - j) );
+        }
+    }
+
+    const std::size_t count = std::min<std::size_t>(chainsPerWorker * pool->size(), N);
+    for( std::size_t k = 0; k < count; ++k )
+    {
+        chains.emplace_back( std::begin(path) + k*N/count, std::begin(path) + (k+1)*N/count );
+    }
+}
+
+
+
+void SweepScheduler::runChain(const std::size_t c, const unsigned int worker)
+{
+    // the points of chain c one after the other on the host of the worker, with warm start each from the lattice
+    // of the one before
+
+    for( std::size_t k = 0; k < chains[c].size(); ++k )
+    {
+        if( ! runPoint(chains[c][k], worker, warmStart && k > 0) ) return;
+    }
+}
+
+
+
+bool SweepScheduler::runPoint(const std::size_t i, const unsigned int worker, const bool warm)
+{
+    // equilibration and production of point i on the host of the worker, false if the sweep has been stopped;
+    // a warm started point ends its equilibration once the monitor finds it stationary
+
+    if( ! running.load() ) return false;
+
+    SimulationParameters P = pointParameters(i);
+    MonteCarloHost& host = *hosts[worker];
+    {
+        std::lock_guard<std::mutex> lock(statusMutex);
+        auto& S = status[worker];
+        S.busy = true;
+        S.value = valueOf(i);
+        S.rowValue = grid ? rowValueOf(i) : 0;
+        S.equilibrating = true;
+        S.stepsDone = 0;
+        S.stepsTotal = P.stepsEquil + P.stepsProd;
+    }
+    const auto start = std::chrono::steady_clock::now();
+
+    if( warm )
+    {
+        // keep the lattice of the previous point, it may have been rounded up in size
+        P.width  = host.getSpinsystem().getWidth();
+        P.height = host.getSpinsystem().getHeight();
+        host.setParameters(P);
+        host.clearRecords();
+    }
+    else
+    {
+        // a copy, so that running the sweep again gives the same numbers
+        auto stream = streams[i];
+        host.setParameters(P);
+        host.setup(stream);
+    }
+
+    EquilibrationMonitor monitor;
+    unsigned long done = 0;
+    unsigned long equilibration = 0;
+    for( const bool EQUILMODE : {true, false} )
+    {
+        const unsigned long steps = EQUILMODE ? P.stepsEquil : P.stepsProd;
+        for( unsigned long phaseDone = 0; phaseDone < steps; phaseDone += P.printFreq )
+        {
+            if( ! running.load() )
+            {
+                std::lock_guard<std::mutex> lock(statusMutex);
+                status[worker].busy = false;
+                return false;
+            }
+            host.run(P.printFreq, EQUILMODE);
+            done += P.printFreq;
+            {
+                std::lock_guard<std::mutex> lock(statusMutex);
+                status[worker].stepsDone = done;
+                status[worker].equilibrating = EQUILMODE;
+            }
+
+            if( EQUILMODE && warm )
+            {
+                monitor.add(host.getSpinsystem().getHamiltonian(), host.getSpinsystem().getMagnetisation());
+                if( monitor.converged() )
+                {
+                    // the remaining equilibration steps are skipped, the production keeps its full length
+                    std::lock_guard<std::mutex> lock(statusMutex);
+                    status[worker].stepsTotal = done + P.stepsProd;
+                    break;
+                }
+            }
+        }
+        if( EQUILMODE )
+        {
+            equilibration = std::min(done, P.stepsEquil);
+        }
+    }
+
+    std::ostringstream row;
+    host.print_averages(row);
+    finishPoint(i, row.str(), host.getAverages(), equilibration);
+    stepsSaved += P.stepsEquil - equilibration;
+    ++pointsDone;
+    {
+        std::lock_guard<std::mutex> lock(statusMutex);
+        status[worker].busy = false;
+        ++status[worker].pointsDone;
+    }
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::ostringstream point;
+    point << valueOf(i);
+    if( grid ) point << ", " << rowValueOf(i);
+    isingLOG("sweep: " << "point " << i+1 << "/" << getPoints() << " (" << point.str() << ") done by worker " << worker << " in " << elapsed.count() << " s, "
+                       << (warm ? "warm start, " : "") << equilibration << " of " << P.stepsEquil << " equilibration steps")
+    return true;
+}
+
+
+
+void SweepScheduler::finishPoint(const std::size_t i, const std::string& row, const Averages& A, const unsigned long equilibration)
+{
+    // keep the results of point i and write all that are complete in sweep order
+
+    std::lock_guard<std::mutex> lock(outputMutex);
+    rows[i] = row;
+    averages[i] = A;
+    equilibrationSteps[i] = equilibration;
+    finished[i] = true;
+    writeRows(false);
+}
+
+
+
+void SweepScheduler::writeRows(const bool stopped)
+{
+    // append the finished points from nextRow on to the .averaged_data file, for a grid also to the .grid file
+    // which is started anew by every run. Up to the first unfinished point, or if the sweep has been stopped
+    // up to the end with the unfinished points left out; outputMutex must be held
+
+    std::size_t last = nextRow;
+    while( last < rows.size() && (finished[last] || stopped) ) ++last;
+    if( last == nextRow ) return;
+
+    const std::size_t first = nextRow;
+    const std::string filekey = fileName(".averaged_data");
+    std::ofstream FILE;
+    if( ! enhance::fileExists(filekey) )
+    {
+        FILE.open(filekey);
+        MonteCarloHost::print_averagesHeader(FILE);
+    }
+    else
+    {
+        FILE.open(filekey, std::ios::app);
+    }
+    for( ; nextRow < last; ++nextRow )
+    {
+        FILE << rows[nextRow];
+        rows[nextRow].clear();
+    }
+
+    if( ! grid ) return;
+
+    std::ofstream GRID;
+    if( first == 0 )
+    {
+        GRID.open(fileName(".grid"));
+        GRID << "# " << parameterName(sweepParameter) << " along the rows, " << parameterName(gridParameter) << " from row to row\n"
+             << "# " << std::setw(10) << parameterName(sweepParameter)
+             << std::setw(12) << parameterName(gridParameter)
+             << std::setw(14) << "<H>"
+             << std::setw(14) << "<M>"
+             << std::setw(18) << "chi"
+             << std::setw(18) << "Cv"
+             << std::setw(10) << "samples"
+             << '\n';
+    }
+    else
+    {
+        GRID.open(fileName(".grid"), std::ios::app);
+    }
+    for( std::size_t j = first; j < last; ++j )
+    {
+        if( finished[j] )
+        {
+            GRID << std::setw(12) << std::fixed << std::setprecision(4) << valueOf(j)
+                 << std::setw(12) << std::fixed << std::setprecision(4) << rowValueOf(j)
+                 << std::setw(14) << std::fixed << std::setprecision(2) << averages[j].energy
+                 << std::setw(14) << std::fixed << std::setprecision(6) << averages[j].magnetisation
+                 << std::setw(18) << std::fixed << std::setprecision(10) << averages[j].susceptibility
+                 << std::setw(18) << std::fixed << std::setprecision(10) << averages[j].heatCapacity
+                 << std::setw(10) << averages[j].samples
+                 << '\n';
+        }
+        // blank line after every row, for splot
+        if( (j + 1) % values.size() == 0 ) GRID << '\n';
+    }
+}
+
+
+
+void SweepScheduler::print_equilibration() const
+{
+    // equilibration steps of every finished point in sweep order, the first point of every chain has a fresh
+    // lattice and always takes the full number
+
+    std::ofstream FILE(fileName(".equilibration"));
+    FILE << "# equilibration steps with warm start, budget " << parameters.stepsEquil << " steps per point\n"
+         << "# " << std::setw(10) << parameterName(sweepParameter);
+    if( grid ) FILE << std::setw(12) << parameterName(gridParameter);
+    FILE << std::setw(14) << "steps"
+         << std::setw(14) << "saved"
+         << '\n';
+
+    for( std::size_t i = 0; i < getPoints(); ++i )
+    {
+        if( ! finished[i] ) continue;
+        FILE << std::setw(12) << std::fixed << std::setprecision(4) << valueOf(i);
+        if( grid ) FILE << std::setw(12) << std::fixed << std::setprecision(4) << rowValueOf(i);
+        FILE << std::setw(14) << equilibrationSteps[i]
+             << std::setw(14) << parameters.stepsEquil - equilibrationSteps[i]
+             << '\n';
+    }
+}
+
+
+
+SimulationParameters SweepScheduler::pointParameters(const std::size_t i) const
+{
+    // the parameters at point i, the workers already use all threads so every host runs single-threaded;
+    // a sweep writes averages only
+
+    SimulationParameters P = parameters;
+    P.threads = 1;
+    P.correlationFreq = 0;
+    P.timeSeries = false;
+    setParameter(P, sweepParameter, valueOf(i));
+    if( grid )
+    {
+        setParameter(P, gridParameter, rowValueOf(i));
+    }
+    return P;
+}
+
+
+
+double SweepScheduler::cost(const std::size_t i) const
+{
+    // relative cost of point i: the autocorrelation time grows towards the critical point of the 2D Ising model,
+    // T_c = 2|J| / ln(1+sqrt(2)) at B = 0. A field smears the susceptibility peak out, it counts as distance as well
+
+    const SimulationParameters P = pointParameters(i);
+    if( P.interaction == 0 || P.temperature <= 0 ) return 1;
+
+    const double Tc = 2*std::abs(P.interaction) / std::log(1 + std::sqrt(2.0));
+    const double distance = std::abs(P.temperature - Tc) / Tc + std::abs(P.magnetic / P.interaction);
+    return 1 / (distance + 0.01);
+}
+
+
+
+std::string SweepScheduler::fileName(const std::string& extension) const
+{
+    std::string filekeystring = parameters.fileKey;
+    std::string filekey = filekeystring.substr( 0, filekeystring.find_first_of(" ") );
+    return filekey.append(extension);
+}
+
+
+
+void SweepScheduler::setParameters(const SimulationParameters& prms)
+{
+    qDebug() << __PRETTY_FUNCTION__;
+
+    parameters = prms;
+}
+
+
+void SweepScheduler::setWarmStart(const bool flag)
+{
+    // takes effect with the next setup()
+    warmStart = flag;
+}
+
+
+void SweepScheduler::setup(const SWEEPPARAMETER _sweepParameter, const std::vector<double>& _values)
+{
+    // a line of points, one host per worker and one random number stream per point,
+    // as many workers as threads but not more than points
+
+    qDebug() << __PRETTY_FUNCTION__;
+    assert( ! _values.empty() );
+
+    sweepParameter = _sweepParameter;
+    values = _values;
+    rowValues.assign(1, 0);
+    grid = false;
+    setupWorkers( std::min<std::size_t>(std::max(1u, parameters.threads), getPoints()) );
+
+    isingLOG("sweep: " << values.size() << " points in " << chains.size() << " chains on " << pool->size() << " workers")
+}
+
+
+void SweepScheduler::setup(const SWEEPPARAMETER _sweepParameter, const std::vector<double>& _values,
+                           const SWEEPPARAMETER _gridParameter, const std::vector<double>& _rowValues)
+{
+    // a grid of _values along the rows times _rowValues, as many workers as threads but not more than points
+
+    qDebug() << __PRETTY_FUNCTION__;
+    assert( ! _values.empty() && ! _rowValues.empty() );
+    assert( _sweepParameter != _gridParameter );
+
+    sweepParameter = _sweepParameter;
+    gridParameter = _gridParameter;
+    values = _values;
+    rowValues = _rowValues;
+    grid = true;
+    setupWorkers( std::min<std::size_t>(std::max(1u, parameters.threads), getPoints()) );
+
+    isingLOG("sweep: " << values.size() << "x" << rowValues.size() << " grid in " << chains.size() << " chains on " << pool->size() << " workers")
+}
+
+
+void SweepScheduler::setupWorkers(const unsigned int workers)
+{
+    if( ! pool || pool->size() != workers )
+    {
+        pool = std::make_unique<enhance::WorkStealingPool>(workers);
+    }
+    hosts.clear();
+    for( unsigned int w = 0; w < workers; ++w )
+    {
+        hosts.emplace_back( std::make_unique<MonteCarloHost>() );
+    }
+    // the streams belong to the points, not to the workers: which worker runs a point is up to the work
+    // stealing, the random numbers of the point must not depend on it
+    streams.clear();
+    for( std::size_t i = 0; i < getPoints(); ++i )
+    {
+        streams.emplace_back( enhance::rand_engine.split() );
+    }
+    makeChains();
+    pointsDone.store(0);
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#ifdef QT_NO_DEBUG
+    #ifndef QT_NO_DEBUG_OUTPUT
+        #define QT_NO_DEBUG_OUTPUT
+    #endif
+#endif
+
+
+#include "simulation_parameters.hpp"
+#include "montecarlohost.hpp"
+#include "equilibration_monitor.hpp"
+#include "lib/enhance.hpp"
+#include "lib/work_stealing_pool.hpp"
+#include "definitions.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+
+// Parallel parameter sweep over a line of values or over a grid of two parameters.
+// The points are grouped into chains that are spread over a work-stealing pool with one MonteCarloHost per
+// worker:
+//   - without warm start every point is a chain of its own
+//   - with warm start the points are walked along a path on which consecutive points are neighbours, and the
+//     path is cut into a few chains of neighbouring points per worker. A line is walked from start to stop;
+//     in a grid the sweep parameter varies along the rows, the grid parameter from row to row, and the path
+//     is a serpentine (every other row backwards). More chains than workers leave the pool something to
+//     steal when chains close to the peak take longer than the others.
+// The first point of a chain starts from a fresh lattice. With warm start every further one starts from the
+// final lattice of its predecessor and ends its equilibration as soon as an EquilibrationMonitor finds energy
+// and magnetisation stationary, at the latest after the full number of steps; without it every point starts
+// from a fresh lattice. Every fresh lattice is set up from a random number stream of its own point, so the same
+// seed gives the same sweep whichever worker a chain ends up on. Chains close to the susceptibility peak
+// decorrelate slowest, so they are started first.
+// The results are written in sweep order (grid: row by row), each as soon as all points before it are done,
+// to .averaged_data and for a grid also to a .grid file, one block per row as read by e.g. gnuplot's splot.
+// A stopped sweep still writes every finished point and leaves out the unfinished ones.
+// With warm start the .equilibration file reports the equilibration steps every point has needed.
+class SweepScheduler
+{
+public:
+    // what a worker is doing, for progress displays
+    struct WorkerStatus
+    {
+        bool          busy {false};
+        double        value {0};              // of the sweep parameter at the current point
+        double        rowValue {0};           // of the grid parameter at the current point
+        bool          equilibrating {false};
+        unsigned long stepsDone {0};
+        unsigned long stepsTotal {0};
+        unsigned int  pointsDone {0};
+    };
+
+    void run();
+    void stop();
+
+    std::vector<WorkerStatus> getStatus() const;
+    std::size_t getPointsDone() const { return pointsDone.load(); }
+    unsigned long getStepsSaved() const { return stepsSaved.load(); }
+    std::size_t getPoints() const { return values.size() * rowValues.size(); }
+    bool isGrid() const { return grid; }
+
+
+private:
+    double valueOf(const std::size_t i) const { return values[i % values.size()]; }
+    double rowValueOf(const std::size_t i) const { return rowValues[i / values.size()]; }
+    SimulationParameters pointParameters(const std::size_t) const;
+    double cost(const std::size_t) const;
+    void setupWorkers(const unsigned int);
+    void makeChains();
+    void runChain(const std::size_t, const unsigned int);
+    bool runPoint(const std::size_t, const unsigned int, const bool);
+    void finishPoint(const std::size_t, const std::string&, const Averages&, const unsigned long);
+    void writeRows(const bool);
+    void print_equilibration() const;
+    std::string fileName(const std::string&) const;
+
+    SimulationParameters parameters {};
+    SWEEPPARAMETER       sweepParameter {SWEEPPARAMETER::Temperature};
+    SWEEPPARAMETER       gridParameter {SWEEPPARAMETER::Magnetic};
+    std::vector<double>  values {};           // along a row
+    std::vector<double>  rowValues {0};       // one per row, a line is a single row
+    bool                 grid {false};
+    bool                 warmStart {true};
+
+    // points are numbered row by row, a chain lists them in the order they are run
+    static constexpr std::size_t chainsPerWorker {3};
+    std::vector<std::vector<std::size_t>> chains {};
+
+    std::unique_ptr<enhance::WorkStealingPool>   pool {};
+    std::vector<std::unique_ptr<MonteCarloHost>> hosts {};      // one per worker
+    std::vector<enhance::Xoshiro256>             streams {};    // one per point, a warm started point goes on with the one of its chain
+
+    mutable std::mutex         statusMutex {};
+    std::vector<WorkerStatus>  status {};
+
+    // results of finished points waiting for the points before them
+    std::mutex                 outputMutex {};
+    std::vector<std::string>   rows {};
+    std::vector<Averages>      averages {};
+    std::vector<unsigned long> equilibrationSteps {};
+    std::vector<bool>          finished {};
+    std::size_t                nextRow {0};
+
+    std::atomic<std::size_t>   pointsDone {0};
+    std::atomic<unsigned long> stepsSaved {0};
+    std::atomic<bool>          running {false};
+
+public:
+    SweepScheduler() = default;
+    SweepScheduler(const SweepScheduler&) = delete;
+    void operator=(const SweepScheduler&) = delete;
+
+    void setParameters(const SimulationParameters&);
+    void setWarmStart(const bool);
+    void setup(const SWEEPPARAMETER, const std::vector<double>&);
+    void setup(const SWEEPPARAMETER, const std::vector<double>&, const SWEEPPARAMETER, const std::vector<double>&);
+};